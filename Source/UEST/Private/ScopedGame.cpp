@@ -1,11 +1,21 @@
 #include "ScopedGame.h"
 #include "Engine/PackageMapClient.h"
+#include "Engine/MapBuildDataRegistry.h"
+#include "Engine/NetConnection.h"
+#include "Engine/PendingNetGame.h"
 #include "EngineUtils.h"
+#include "GameFramework/PlayerState.h"
 #include "GameMapsSettings.h"
 #include "Iris/ReplicationSystem/ObjectReplicationBridge.h"
 #include "Iris/ReplicationSystem/ReplicationSystem.h"
+#include "Misc/AutomationTest.h"
 #include "Misc/EngineVersionComparison.h"
+#include "Misc/PackageName.h"
+#include "Misc/ScopeLock.h"
 #include "Net/OnlineEngineInterface.h"
+#include "String/Find.h"
+#include "UObject/UObjectArray.h"
+#include "UObject/UObjectHash.h"
 
 #if !UE_VERSION_OLDER_THAN(5, 3, 0)
 #include "Runtime/Core/Internal/Misc/PlayInEditorLoadingScope.h"
@@ -13,6 +23,9 @@
 
 #include "UESTGameInstance.h"
 #include "UESTHelpers.h"
+#include "UESTLoopbackNetDriver.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogUESTScopedGame, Log, All);
 
 struct FGWorldGuard final : FNoncopyable
 {
@@ -57,6 +70,84 @@ struct FCVarsGuard final : FNoncopyable
 
 static TUniquePtr<FCVarsGuard> CVarsGuard;
 
+struct FGameNetDriverGuard final : FNoncopyable
+{
+	explicit FGameNetDriverGuard(const FName DriverClassName)
+	{
+		for (auto& Definition : GEngine->NetDriverDefinitions)
+		{
+			if (Definition.DefName == NAME_GameNetDriver)
+			{
+				OldDefinitions.Add(Definition);
+				Definition.DriverClassName = DriverClassName;
+				Definition.DriverClassNameFallback = DriverClassName;
+			}
+		}
+	}
+
+	~FGameNetDriverGuard()
+	{
+		for (auto& Definition : GEngine->NetDriverDefinitions)
+		{
+			if (const auto* OldDefinition = OldDefinitions.FindByPredicate([&](const FNetDriverDefinition& Old) { return Old.DefName == Definition.DefName; }))
+			{
+				Definition = *OldDefinition;
+			}
+		}
+	}
+
+private:
+	TArray<FNetDriverDefinition> OldDefinitions;
+};
+
+static TUniquePtr<FGameNetDriverGuard> GameNetDriverGuard;
+
+struct FLoopbackNetworkEmulationGuard final : FNoncopyable
+{
+	explicit FLoopbackNetworkEmulationGuard(const FScopedGameNetworkEmulation& Emulation)
+	{
+		UUESTLoopbackNetDriver::SetNetworkEmulation(Emulation.LagSeconds, Emulation.LossRatio, Emulation.RandomSeed);
+	}
+
+	~FLoopbackNetworkEmulationGuard()
+	{
+		UUESTLoopbackNetDriver::SetNetworkEmulation(0, 0);
+	}
+};
+
+static TUniquePtr<FLoopbackNetworkEmulationGuard> LoopbackNetworkEmulationGuard;
+
+/** Networking settings of the outermost scope, which nested scopes have to match because net driver definitions and emulation are process-wide */
+static bool bScopesUseInMemoryNetworking = false;
+static FScopedGameNetworkEmulation ScopesNetworkEmulation;
+
+/** Virtual time moves engine clock forward, so it is put back once tests are done with it */
+struct FAppTimeGuard final : FNoncopyable
+{
+	[[nodiscard]] FAppTimeGuard()
+	    : CurrentTime{FApp::GetCurrentTime()}
+	    , LastTime{FApp::GetLastTime()}
+	    , DeltaTime{FApp::GetDeltaTime()}
+	{
+	}
+
+	~FAppTimeGuard()
+	{
+		// FApp can only set last time by copying current one
+		FApp::SetCurrentTime(LastTime);
+		FApp::UpdateLastTime();
+		FApp::SetCurrentTime(CurrentTime);
+		FApp::SetDeltaTime(DeltaTime);
+	}
+
+private:
+	const double CurrentTime;
+	const double LastTime;
+	const double DeltaTime;
+};
+
+static TUniquePtr<FAppTimeGuard> AppTimeGuard;
+
 struct FNetDriverTickRateAdjuster final : FNoncopyable
 {
 	[[nodiscard]] FNetDriverTickRateAdjuster()
@@ -81,10 +172,152 @@ private:
 
 static TUniquePtr<FNetDriverTickRateAdjuster> NetDriverTickRateAdjuster;
 
-FScopedGameInstance::FScopedGameInstance(TSubclassOf<UGameInstance> GameInstanceClass, const EWorldType::Type WorldType, const TMap<IConsoleVariable*, FString>& CVars)
+/**
+ * Worlds that were loaded once and are kept rooted so UEngine::LoadMap can duplicate them for PIE
+ * (see UWorld::DuplicateWorldForPIE) instead of loading map package from disk for every game.
+ */
+static TMap<FName, TWeakObjectPtr<UWorld>> MapTemplates;
+
+/**
+ * Idle game instances kept alive by FScopedGame::WithPooling. They are rooted while they sit in the pool.
+ */
+static TArray<TWeakObjectPtr<UGameInstance>> GamePool;
+
+/**
+ * PIE instances of destroyed games whose worlds were not garbage collected yet.
+ * They cannot be reused until collection happens because new PIE world packages would clash with old ones.
+ */
+static TSet<int32> PendingGarbagePIEInstances;
+
+/**
+ * Packages of destroyed game worlds that were not garbage collected yet.
+ * Before collection, we clear RF_Standalone from their objects so they can actually be collected.
+ */
+static TSet<TWeakObjectPtr<UPackage>> PendingGarbagePackages;
+
+static void TrackWorldPackages(const UWorld& World)
+{
+	PendingGarbagePackages.Add(World.GetOutermost());
+
+	for (const auto& Level : World.GetLevels())
+	{
+		if (!Level)
+		{
+			continue;
+		}
+
+		PendingGarbagePackages.Add(Level->GetOutermost());
+
+		if (Level->MapBuildData)
+		{
+			PendingGarbagePackages.Add(Level->MapBuildData->GetOutermost());
+		}
+
+		// One file per actor levels keep actors in their own packages
+		for (const auto& Actor : Level->Actors)
+		{
+			if (auto* ExternalPackage = Actor ? Actor->GetExternalPackage() : nullptr)
+			{
+				PendingGarbagePackages.Add(ExternalPackage);
+			}
+		}
+	}
+}
+
+/** Map templates and pooled games must not outlive the automation run that created them, otherwise they stay in memory until editor exits */
+static void OnAfterAllTests()
+{
+	FScopedGameInstance::DrainGamePool();
+	FScopedGameInstance::ClearMapTemplateCache();
+}
+
+static void RegisterAutomationCleanup()
+{
+	[[maybe_unused]] static const auto Handle = FAutomationTestFramework::Get().OnAfterAllTestsEvent.AddStatic(&OnAfterAllTests);
+}
+
+/**
+ * Games destroyed since last garbage collection. Games released to pool only leave their old world behind,
+ * which TakePooledGame collects if it is still around when game is reused, so they alone do not justify collection.
+ */
+static int32 NumGamesDestroyedSinceCollection = 0;
+
+/**
+ * Names of packages created with PIE prefix, by PIE instance. Unlike TrackWorldPackages, this also catches packages
+ * that are no longer referenced by world when game is destroyed, such as streaming levels that were already unloaded.
+ */
+static TMap<int32, TSet<FName>> PIEPackageNames;
+
+static FCriticalSection PIEPackageNamesCriticalSection;
+
+/** Fills PIEPackageNames while scoped games exist. Packages are created on async loading thread too */
+struct FPIEPackageTracker final : FUObjectArray::FUObjectCreateListener, FNoncopyable
+{
+	[[nodiscard]] FPIEPackageTracker()
+	{
+		GUObjectArray.AddUObjectCreateListener(this);
+	}
+
+	virtual ~FPIEPackageTracker() override
+	{
+		if (bRegistered)
+		{
+			GUObjectArray.RemoveUObjectCreateListener(this);
+		}
+	}
+
+	virtual void NotifyUObjectCreated(const UObjectBase* Object, const int32 Index) override
+	{
+		if (Object->GetClass() != UPackage::StaticClass())
+		{
+			return;
+		}
+
+		// See UWorld::ConvertToPIEPackageName, PIE packages are named like /Game/Maps/UEDPIE_3_MapName
+		constexpr auto Prefix = TEXTVIEW("/" PLAYWORLD_PACKAGE_PREFIX "_");
+		const FNameBuilder PackageName{Object->GetFName()};
+		const auto PrefixIndex = UE::String::FindFirst(PackageName.ToView(), Prefix);
+		if (PrefixIndex == INDEX_NONE)
+		{
+			return;
+		}
+
+		const auto PIEInstance = FCString::Atoi(PackageName.ToString() + PrefixIndex + Prefix.Len());
+
+		const FScopeLock Lock{&PIEPackageNamesCriticalSection};
+		PIEPackageNames.FindOrAdd(PIEInstance).Add(Object->GetFName());
+	}
+
+	virtual void OnUObjectArrayShutdown() override
+	{
+		GUObjectArray.RemoveUObjectCreateListener(this);
+		bRegistered = false;
+	}
+
+private:
+	bool bRegistered = true;
+};
+
+static TUniquePtr<FPIEPackageTracker> PIEPackageTracker;
+
+static int32 NumScopesSinceCollection = 0;
+
+static int32 NumCollectionsSinceStaleWorldCheck = 0;
+
+FScopedGameInstance::FScopedGameInstance(TSubclassOf<UGameInstance> GameInstanceClass, const EWorldType::Type WorldType, const TMap<IConsoleVariable*, FString>& CVars, const bool bUseMapTemplateCache, const bool bUsePooling, const FScopedGameGCPolicy& GCPolicy, const bool bUseVirtualTime, const bool bProfileTicks, const FScopedGameStreamingSettings& StreamingSettings, const bool bUseInMemoryNetworking, const FScopedGameNetworkEmulation& NetworkEmulation)
     : GameInstanceClass{MoveTemp(GameInstanceClass)}
     , WorldType{WorldType}
+    , bUseMapTemplateCache{bUseMapTemplateCache}
+    , bUsePooling{bUsePooling}
+    , GCPolicy{GCPolicy}
+    , bUseVirtualTime{bUseVirtualTime}
+    , StreamingSettings{StreamingSettings}
 {
+	if (bProfileTicks)
+	{
+		TickProfile.Emplace();
+	}
+
 	if (NumScopedGames == 0)
 	{
 		CVarsGuard = MakeUnique<FCVarsGuard>();
@@ -98,6 +331,29 @@ FScopedGameInstance::FScopedGameInstance(TSubclassOf<UGameInstance> GameInstance
 		}
 
 		NetDriverTickRateAdjuster = MakeUnique<FNetDriverTickRateAdjuster>();
+		PIEPackageTracker = MakeUnique<FPIEPackageTracker>();
+
+		if (bUseInMemoryNetworking)
+		{
+			GameNetDriverGuard = MakeUnique<FGameNetDriverGuard>(*UUESTLoopbackNetDriver::StaticClass()->GetPathName());
+			LoopbackNetworkEmulationGuard = MakeUnique<FLoopbackNetworkEmulationGuard>(NetworkEmulation);
+		}
+
+		bScopesUseInMemoryNetworking = bUseInMemoryNetworking;
+		ScopesNetworkEmulation = NetworkEmulation;
+	}
+	else
+	{
+		ensureAlwaysMsgf(bUseInMemoryNetworking == bScopesUseInMemoryNetworking, TEXT("Nested scope has to use the same in-memory networking setting as the outer one"));
+		ensureAlwaysMsgf(NetworkEmulation == ScopesNetworkEmulation, TEXT("Nested scope has to use the same network emulation as the outer one"));
+	}
+
+	ensureAlwaysMsgf(bUseInMemoryNetworking || (NetworkEmulation.LagSeconds <= 0 && NetworkEmulation.LossRatio <= 0), TEXT("Network emulation requires in-memory networking"));
+
+	// Outer scope may not use virtual time, but engine clock has to be restored anyway
+	if (bUseVirtualTime && !AppTimeGuard)
+	{
+		AppTimeGuard = MakeUnique<FAppTimeGuard>();
 	}
 
 	++NumScopedGames;
@@ -106,24 +362,54 @@ FScopedGameInstance::FScopedGameInstance(TSubclassOf<UGameInstance> GameInstance
 FScopedGameInstance::FScopedGameInstance(FScopedGameInstance&& Other)
     : GameInstanceClass{MoveTemp(Other.GameInstanceClass)}
     , WorldType{Other.WorldType}
+    , bUseMapTemplateCache{Other.bUseMapTemplateCache}
+    , bUsePooling{Other.bUsePooling}
+    , GCPolicy{Other.GCPolicy}
+    , bUseVirtualTime{Other.bUseVirtualTime}
+    , TickProfile{MoveTemp(Other.TickProfile)}
+    , StreamingSettings{Other.StreamingSettings}
     , Games{MoveTemp(Other.Games)}
+    , GameTickStates{MoveTemp(Other.GameTickStates)}
+    , NetStatsBaselines{MoveTemp(Other.NetStatsBaselines)}
+    , NetStatsSeconds{Other.NetStatsSeconds}
+    , ObjectMaps{MoveTemp(Other.ObjectMaps)}
+    , Checkpoints{MoveTemp(Other.Checkpoints)}
 {
 	++NumScopedGames;
 }
 
 FScopedGameInstance::~FScopedGameInstance()
 {
+	ObjectMaps.Empty();
+
 	for (const auto& Game : Games)
 	{
-		DestroyGameInternal(*Game);
+		DestroyOrReleaseGame(*Game);
 	}
 
-	const bool bCollectGarbage = !Games.IsEmpty();
 	Games.Empty();
 
-	if (bCollectGarbage)
+	if (TickProfile && !TickProfile->Frames.IsEmpty())
 	{
-		CollectGarbage();
+		const auto Summary = TickProfile->GetSummary();
+		if (auto* CurrentTest = FAutomationTestFramework::Get().GetCurrentTest())
+		{
+			CurrentTest->AddInfo(Summary);
+		}
+		else
+		{
+			UE_LOG(LogUESTScopedGame, Display, TEXT("%s"), *Summary);
+		}
+	}
+
+	if (NumGamesDestroyedSinceCollection > 0)
+	{
+		++NumScopesSinceCollection;
+
+		if (IsGarbageCollectionDueAtScopeEnd())
+		{
+			CollectGarbage(GCPolicy.StaleWorldCheckInterval);
+		}
 	}
 
 	--NumScopedGames;
@@ -132,6 +418,10 @@ FScopedGameInstance::~FScopedGameInstance()
 	{
 		CVarsGuard.Reset();
 		NetDriverTickRateAdjuster.Reset();
+		PIEPackageTracker.Reset();
+		GameNetDriverGuard.Reset();
+		LoopbackNetworkEmulationGuard.Reset();
+		AppTimeGuard.Reset();
 	}
 }
 
@@ -153,6 +443,68 @@ struct FGPlayInEditorIDGuard final : TGuardValue<decltype(GPlayInEditorID), int3
 };
 #endif
 
+/**
+ * High-priority tick function that runs at the start of its tick group and records when that was.
+ */
+struct FTickGroupMarker final : FTickFunction
+{
+	double StartTime = 0;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override
+	{
+		StartTime = FPlatformTime::Seconds();
+	}
+
+	virtual FString DiagnosticMessage() override
+	{
+		return TEXT("UEST tick group marker");
+	}
+};
+
+/**
+ * Splits UWorld::Tick into tick groups for FScopedGameFrameProfile. Markers are registered only for the duration of a single world tick,
+ * so they are never left behind in a world that is destroyed or travels
+ */
+struct FTickGroupMarkers final : FNoncopyable
+{
+	TStaticArray<FTickGroupMarker, FScopedGameFrameProfile::NumTickGroups> Markers;
+
+	explicit FTickGroupMarkers(const UWorld& World)
+	{
+		for (int32 TickGroup = 0; TickGroup < Markers.Num(); ++TickGroup)
+		{
+			auto& Marker = Markers[TickGroup];
+			Marker.TickGroup = static_cast<ETickingGroup>(TickGroup);
+			Marker.EndTickGroup = Marker.TickGroup;
+			Marker.bCanEverTick = true;
+			Marker.bTickEvenWhenPaused = true;
+			Marker.bHighPriority = true;
+			Marker.RegisterTickFunction(World.PersistentLevel);
+		}
+	}
+
+	~FTickGroupMarkers()
+	{
+		for (auto& Marker : Markers)
+		{
+			Marker.UnRegisterTickFunction();
+		}
+	}
+
+	/** Every tick group lasts until the next one starts, the last one until EndTime. Groups that did not run, for example in LEVELTICK_TimeOnly, get no time */
+	void GetTickGroupSeconds(FScopedGameFrameProfile::FTickGroupSeconds& OutSeconds, double EndTime) const
+	{
+		for (int32 TickGroup = Markers.Num() - 1; TickGroup >= 0; --TickGroup)
+		{
+			if (const auto StartTime = Markers[TickGroup].StartTime; StartTime > 0)
+			{
+				OutSeconds[TickGroup] = EndTime - StartTime;
+				EndTime = StartTime;
+			}
+		}
+	}
+};
+
 int32 FScopedGameInstance::FindFreePIEInstance()
 {
 	TSet<int32> UsedPIEIndices;
@@ -161,6 +513,8 @@ int32 FScopedGameInstance::FindFreePIEInstance()
 		UsedPIEIndices.Add(WorldContext.PIEInstance);
 	}
 
+	UsedPIEIndices.Append(PendingGarbagePIEInstances);
+
 	int32 Result = 0;
 
 	while (UsedPIEIndices.Contains(Result))
@@ -171,17 +525,76 @@ int32 FScopedGameInstance::FindFreePIEInstance()
 	return Result;
 }
 
-UGameInstance* FScopedGameInstance::CreateGame(const EScopedGameType Type, FString MapToLoad, const bool bWaitForConnect)
+void FScopedGameInstance::PreloadMapTemplate(const FURL& URL)
 {
-	const auto PIEInstance = FindFreePIEInstance();
-	if (!ensureAlwaysMsgf(PIEInstance < 10, TEXT("Attempt to create too many games at the same time! See MAX_PIE_INSTANCES in Unreal Engine")))
+#if WITH_EDITOR
+	// Network addresses are not maps, we will learn actual map name only after connecting to server
+	if (!URL.IsLocalInternal() || !FPackageName::IsValidLongPackageName(URL.Map))
 	{
-		return nullptr;
+		return;
 	}
 
-	if (MapToLoad.IsEmpty())
+	const FName PackageName{*URL.Map};
+	if (const auto* Template = MapTemplates.Find(PackageName); Template && Template->IsValid())
 	{
-		MapToLoad = GetDefault<UGameMapsSettings>()->GetGameDefaultMap();
+		return;
+	}
+
+	// Load template as a regular non-PIE package, PIE copies will be made out of it
+	const TGuardValue GIsPlayInEditorWorldGuard(GIsPlayInEditorWorld, false);
+	const FGPlayInEditorIDGuard GPlayInEditorIDGuard(INDEX_NONE);
+
+	auto* Package = LoadPackage(nullptr, *URL.Map, LOAD_None);
+	auto* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (!World)
+	{
+		// Let UEngine::Browse report the error
+		return;
+	}
+
+	// Do not take ownership of worlds that are already rooted by someone else (for example, currently opened editor world)
+	if (!World->IsRooted())
+	{
+		World->AddToRoot();
+		MapTemplates.Emplace(PackageName, World);
+		RegisterAutomationCleanup();
+	}
+#endif
+}
+
+void FScopedGameInstance::ClearMapTemplateCache()
+{
+	for (const auto& [PackageName, World] : MapTemplates)
+	{
+		if (auto* Template = World.Get())
+		{
+			Template->RemoveFromRoot();
+		}
+	}
+
+	MapTemplates.Empty();
+}
+
+/** Editor never runs more than MAX_PIE_INSTANCES PIE sessions at once and some engine systems rely on that */
+static constexpr int32 MaxEnginePIEInstances = 10;
+
+UGameInstance* FScopedGameInstance::NewGame(const EScopedGameType Type)
+{
+	// Unlike editor, we do not limit ourselves to MAX_PIE_INSTANCES.
+	// Each game gets its own PIE prefix (see UWorld::BuildPIEPackagePrefix) that is unique as long as PIE instance is unique.
+	auto PIEInstance = FindFreePIEInstance();
+	if (PIEInstance >= MaxEnginePIEInstances && !PendingGarbagePIEInstances.IsEmpty())
+	{
+		// Destroyed games that were not collected yet still occupy their PIE instances, reclaim them before going above engine limit
+		CollectGarbage(GCPolicy.StaleWorldCheckInterval);
+		PIEInstance = FindFreePIEInstance();
+	}
+
+	if (PIEInstance >= MaxEnginePIEInstances)
+	{
+		// Fixup of lazy object pointers in PIE (see FUniqueObjectGuid::FixupForPIE) keeps MAX_PIE_INSTANCES GUID maps and picks one by PIE instance modulo limit.
+		// Everything else, such as package prefixes and GPlayInEditorID, is unique per PIE instance, so only tests that use TLazyObjectPtr are affected
+		UE_LOG(LogUESTScopedGame, Warning, TEXT("PIE instance %d is above engine limit of %d simultaneous games, TLazyObjectPtr may resolve to an object of another game whose PIE instance differs by a multiple of %d"), PIEInstance, MaxEnginePIEInstances, MaxEnginePIEInstances);
 	}
 
 	auto* Game = NewObject<UGameInstance>(GEngine, GameInstanceClass);
@@ -211,6 +624,11 @@ UGameInstance* FScopedGameInstance::CreateGame(const EScopedGameType Type, FStri
 
 	ensureAlwaysMsgf(WorldContext->PIEInstance == PIEInstance, TEXT("WorldContext must use supplied PIEInstance"));
 
+	if (TickProfile)
+	{
+		TickProfile->AddGame(*Game);
+	}
+
 	if (Type == EScopedGameType::Client)
 	{
 		WorldContext->GameViewport = NewObject<UGameViewportClient>(Game->GetEngine(), Game->GetEngine()->GameViewportClientClass);
@@ -222,286 +640,1162 @@ UGameInstance* FScopedGameInstance::CreateGame(const EScopedGameType Type, FStri
 			return nullptr;
 		}
 	}
-
-	if (!MapToLoad.IsEmpty())
+	else if (Type == EScopedGameType::HeadlessClient)
 	{
-		FURL URL(nullptr, *MapToLoad, TRAVEL_Absolute);
-
-		if (Type == EScopedGameType::Server)
+		// UGameInstance::CreateLocalPlayer insists on viewport, so local player is added directly
+		auto* LocalPlayer = NewObject<ULocalPlayer>(Game->GetEngine(), Game->GetEngine()->LocalPlayerClass);
+#if UE_VERSION_OLDER_THAN(5, 3, 0)
+		const auto PlayerIndex = Game->AddLocalPlayer(LocalPlayer, 0);
+#else
+		const auto PlayerIndex = Game->AddLocalPlayer(LocalPlayer, FPlatformMisc::GetPlatformUserForUserIndex(0));
+#endif
+		if (!ensureAlwaysMsgf(PlayerIndex != INDEX_NONE, TEXT("Failed to create local player")))
 		{
-			URL.AddOption(TEXT("listen"));
+			DestroyGame(Game);
+			return nullptr;
 		}
+	}
 
-		const TGuardValue GIsPlayInEditorWorldGuard(GIsPlayInEditorWorld, false);
-		const FGPlayInEditorIDGuard GPlayInEditorIDGuard(Game->GetWorldContext()->PIEInstance);
-		const FGWorldGuard GWorldGuard;
+	return Game;
+}
 
-		FString Error;
-		const auto BrowseResult = Game->GetEngine()->Browse(*WorldContext, URL, Error);
-		if (BrowseResult == EBrowseReturnVal::Pending)
+UGameInstance* FScopedGameInstance::TakePooledGame(const EScopedGameType Type)
+{
+	for (int32 Index = 0; Index < GamePool.Num(); ++Index)
+	{
+		auto* Game = GamePool[Index].Get();
+		if (!Game || Game->GetClass() != GameInstanceClass || Game->GetWorldContext()->WorldType != WorldType || GetGameType(*Game) != Type)
 		{
-			if (bWaitForConnect)
-			{
-				const auto CheckConnection = [&] {
-					if (Game->GetWorldContext()->PendingNetGame)
-					{
-						return EScopedGameConnectError::PendingNetGame;
-					}
-
-					const auto* ClientWorld = Game->GetWorld();
-
-					const auto* NetDriver = ClientWorld->GetNetDriver();
-					if (!NetDriver)
-					{
-						return EScopedGameConnectError::NoNetDriver;
-					}
-
-					if (!NetDriver->ServerConnection)
-					{
-						return EScopedGameConnectError::NoServerConnection;
-					}
-
-					if (NetDriver->ServerConnection->URL != URL)
-					{
-						return EScopedGameConnectError::WrongURL;
-					}
-
-					if (!ClientWorld->GetGameState())
-					{
-						return EScopedGameConnectError::NoGameState;
-					}
-
-					const auto* ClientPC = ClientWorld->GetFirstPlayerController();
-					if (!ClientPC)
-					{
-						return EScopedGameConnectError::NoClientPC;
-					}
-
-					if (!ClientPC->PlayerState)
-					{
-						return EScopedGameConnectError::NoClientPS;
-					}
-
-					return EScopedGameConnectError::Success;
-				};
+			continue;
+		}
 
-				EScopedGameConnectError ConnectError = EScopedGameConnectError::Success;
-				if (!TickUntil([&] { ConnectError = CheckConnection(); return ConnectError == EScopedGameConnectError::Success; }))
-				{
-					ensureAlwaysMsgf(false, TEXT("Timeout connecting to dedicated server: %s"), *ToString(ConnectError));
-					DestroyGame(Game);
-					return nullptr;
-				}
-			}
+		GamePool.RemoveAt(Index);
+		Game->RemoveFromRoot();
+		Games.Emplace(Game);
+		if (TickProfile)
+		{
+			TickProfile->AddGame(*Game);
 		}
-		else if (!ensureAlways(BrowseResult == EBrowseReturnVal::Success))
+
+		// Old world of this game has to be gone before we load a new one with the same PIE prefix
+		if (PendingGarbagePIEInstances.Contains(Game->GetWorldContext()->PIEInstance))
 		{
-			DestroyGame(Game);
-			return nullptr;
+			CollectGarbage(GCPolicy.StaleWorldCheckInterval);
 		}
+
+		return Game;
 	}
 
-	return Game;
+	return nullptr;
 }
 
-UGameInstance* FScopedGameInstance::CreateClientFor(const UGameInstance& Server, const bool bWaitForConnect)
+/**
+ * Catches network and travel failures of connecting games, so waiting for connection can stop on the very frame engine gives up
+ * instead of waiting for timeout.
+ */
+struct FConnectFailureWatcher final : FNoncopyable
 {
-	if (!ensure(Server.GetWorld()->NetDriver) || !ensure(Server.GetWorld()->NetDriver->IsServer()))
+	struct FFailure final
 	{
-		return nullptr;
-	}
+		EScopedGameConnectError Error = EScopedGameConnectError::Success;
+		FString Reason;
+	};
 
-	return CreateGame(EScopedGameType::Client, FString::Printf(TEXT("127.0.0.1:%d"), Server.GetWorld()->URL.Port), bWaitForConnect);
-}
+	explicit FConnectFailureWatcher(const TConstArrayView<UGameInstance*> InGames)
+	    : Games{InGames}
+	{
+		NetworkFailureHandle = GEngine->OnNetworkFailure().AddRaw(this, &FConnectFailureWatcher::OnNetworkFailure);
+		TravelFailureHandle = GEngine->OnTravelFailure().AddRaw(this, &FConnectFailureWatcher::OnTravelFailure);
+	}
+
+	~FConnectFailureWatcher()
+	{
+		GEngine->OnNetworkFailure().Remove(NetworkFailureHandle);
+		GEngine->OnTravelFailure().Remove(TravelFailureHandle);
+	}
+
+	[[nodiscard]] const FFailure* Find(const UGameInstance& Game) const
+	{
+		return Failures.Find(&Game);
+	}
+
+private:
+	TArray<UGameInstance*> Games;
+
+	TMap<const UGameInstance*, FFailure> Failures;
+
+	FDelegateHandle NetworkFailureHandle;
+
+	FDelegateHandle TravelFailureHandle;
+
+	[[nodiscard]] UGameInstance* FindGame(const UWorld* World, const UNetDriver* NetDriver) const
+	{
+		for (auto* Game : Games)
+		{
+			if (!Game)
+			{
+				continue;
+			}
+
+			// Failures of pending connection are reported without world, only with net driver of pending net game
+			const auto* WorldContext = Game->GetWorldContext();
+			const auto* PendingNetDriver = WorldContext && WorldContext->PendingNetGame ? WorldContext->PendingNetGame->NetDriver.Get() : nullptr;
+			const auto* GameWorld = Game->GetWorld();
+			if ((World && World == GameWorld) || (NetDriver && (NetDriver == PendingNetDriver || (GameWorld && NetDriver == GameWorld->GetNetDriver()))))
+			{
+				return Game;
+			}
+		}
+
+		return nullptr;
+	}
+
+	void OnNetworkFailure(UWorld* World, UNetDriver* NetDriver, const ENetworkFailure::Type FailureType, const FString& ErrorString)
+	{
+		if (const auto* Game = FindGame(World, NetDriver))
+		{
+			Failures.Add(Game, {EScopedGameConnectError::NetworkFailure, FString::Printf(TEXT("%s: %s"), ENetworkFailure::ToString(FailureType), *ErrorString)});
+		}
+	}
+
+	void OnTravelFailure(UWorld* World, const ETravelFailure::Type FailureType, const FString& ErrorString)
+	{
+		if (const auto* Game = FindGame(World, nullptr))
+		{
+			Failures.Add(Game, {EScopedGameConnectError::TravelFailure, FString::Printf(TEXT("%s: %s"), ETravelFailure::ToString(FailureType), *ErrorString)});
+		}
+	}
+};
+
+EScopedGameConnectError FScopedGameInstance::CheckConnection(const UGameInstance& Game, const FURL& URL)
+{
+	if (Game.GetWorldContext()->PendingNetGame)
+	{
+		return EScopedGameConnectError::PendingNetGame;
+	}
+
+	const auto* ClientWorld = Game.GetWorld();
+
+	const auto* NetDriver = ClientWorld->GetNetDriver();
+	if (!NetDriver)
+	{
+		return EScopedGameConnectError::NoNetDriver;
+	}
+
+	if (!NetDriver->ServerConnection)
+	{
+		return EScopedGameConnectError::NoServerConnection;
+	}
+
+	if (NetDriver->ServerConnection->URL != URL)
+	{
+		return EScopedGameConnectError::WrongURL;
+	}
+
+	if (!ClientWorld->GetGameState())
+	{
+		return EScopedGameConnectError::NoGameState;
+	}
+
+	const auto* ClientPC = ClientWorld->GetFirstPlayerController();
+	if (!ClientPC)
+	{
+		return EScopedGameConnectError::NoClientPC;
+	}
+
+	if (!ClientPC->PlayerState)
+	{
+		return EScopedGameConnectError::NoClientPS;
+	}
+
+	return EScopedGameConnectError::Success;
+}
+
+UGameInstance* FScopedGameInstance::CreateGame(const EScopedGameType Type, FString MapToLoad, const bool bWaitForConnect)
+{
+	if (MapToLoad.IsEmpty())
+	{
+		MapToLoad = GetDefault<UGameMapsSettings>()->GetGameDefaultMap();
+	}
+
+	auto* Game = bUsePooling ? TakePooledGame(Type) : nullptr;
+	if (!Game)
+	{
+		Game = NewGame(Type);
+	}
+
+	if (!Game)
+	{
+		return nullptr;
+	}
+
+	auto* WorldContext = Game->GetWorldContext();
+
+	if (!MapToLoad.IsEmpty())
+	{
+		FURL URL(nullptr, *MapToLoad, TRAVEL_Absolute);
+
+		if (Type == EScopedGameType::Server)
+		{
+			URL.AddOption(TEXT("listen"));
+		}
+
+		if (bUseMapTemplateCache && WorldType == EWorldType::PIE)
+		{
+			PreloadMapTemplate(URL);
+		}
+
+		const TGuardValue GIsPlayInEditorWorldGuard(GIsPlayInEditorWorld, false);
+		const FGPlayInEditorIDGuard GPlayInEditorIDGuard(Game->GetWorldContext()->PIEInstance);
+		const FGWorldGuard GWorldGuard;
+
+		FString Error;
+		const auto BrowseResult = Game->GetEngine()->Browse(*WorldContext, URL, Error);
+		if (BrowseResult == EBrowseReturnVal::Pending)
+		{
+			if (bWaitForConnect)
+			{
+				const FConnectFailureWatcher FailureWatcher{MakeArrayView(&Game, 1)};
+				EScopedGameConnectError ConnectError = EScopedGameConnectError::Success;
+				if (!TickUntil([&] { ConnectError = CheckConnection(*Game, URL); return ConnectError == EScopedGameConnectError::Success || FailureWatcher.Find(*Game); }) || ConnectError != EScopedGameConnectError::Success)
+				{
+					if (const auto* Failure = FailureWatcher.Find(*Game))
+					{
+						ensureAlwaysMsgf(false, TEXT("Failed connecting to dedicated server: %s: %s"), *ToString(Failure->Error), *Failure->Reason);
+					}
+					else
+					{
+						ensureAlwaysMsgf(false, TEXT("Timeout connecting to dedicated server: %s"), *ToString(ConnectError));
+					}
+
+					DestroyGame(Game);
+					return nullptr;
+				}
+			}
+		}
+		else if (!ensureAlways(BrowseResult == EBrowseReturnVal::Success))
+		{
+			DestroyGame(Game);
+			return nullptr;
+		}
+	}
+
+	return Game;
+}
+
+FString FScopedGameInstance::GetServerAddress(const UGameInstance& Server)
+{
+	if (!ensure(Server.GetWorld()->NetDriver) || !ensure(Server.GetWorld()->NetDriver->IsServer()))
+	{
+		return {};
+	}
+
+	return FString::Printf(TEXT("127.0.0.1:%d"), Server.GetWorld()->URL.Port);
+}
+
+UGameInstance* FScopedGameInstance::CreateClientFor(const UGameInstance& Server, const bool bWaitForConnect, const EScopedGameType ClientType)
+{
+	if (!ensureAlwaysMsgf(ClientType == EScopedGameType::Client || ClientType == EScopedGameType::HeadlessClient, TEXT("Unsupported client type: %d"), static_cast<int32>(ClientType)))
+	{
+		return nullptr;
+	}
+
+	const auto ServerAddress = GetServerAddress(Server);
+	if (ServerAddress.IsEmpty())
+	{
+		return nullptr;
+	}
+
+	return CreateGame(ClientType, ServerAddress, bWaitForConnect);
+}
+
+TArray<UGameInstance*> FScopedGameInstance::CreateClientsFor(const UGameInstance& Server, const int32 NumClients, TArray<EScopedGameConnectError>* OutErrors, const EScopedGameType ClientType)
+{
+	TArray<UGameInstance*> Clients;
+	TArray<EScopedGameConnectError> Errors;
+	Errors.Init(EScopedGameConnectError::CreateFailed, NumClients);
+
+	const auto ServerAddress = GetServerAddress(Server);
+	if (ServerAddress.IsEmpty())
+	{
+		Clients.Init(nullptr, NumClients);
+		if (OutErrors)
+		{
+			*OutErrors = MoveTemp(Errors);
+		}
+
+		return Clients;
+	}
+
+	// Start all handshakes first, so they progress simultaneously
+	Clients.Reserve(NumClients);
+	for (int32 Index = 0; Index < NumClients; ++Index)
+	{
+		auto* Client = Clients.Add_GetRef(CreateGame(ClientType, ServerAddress, false));
+		if (Client)
+		{
+			Errors[Index] = EScopedGameConnectError::PendingNetGame;
+		}
+	}
+
+	const FURL URL(nullptr, *ServerAddress, TRAVEL_Absolute);
+
+	// Failed clients stop being waited for right away, so a single bad client does not hold up the rest until timeout
+	const FConnectFailureWatcher FailureWatcher{Clients};
+	(void)TickUntil([&] {
+		bool bAllDone = true;
+
+		for (int32 Index = 0; Index < NumClients; ++Index)
+		{
+			if (!Clients[Index] || Errors[Index] == EScopedGameConnectError::Success || Errors[Index] == EScopedGameConnectError::NetworkFailure || Errors[Index] == EScopedGameConnectError::TravelFailure)
+			{
+				continue;
+			}
+
+			if (const auto* Failure = FailureWatcher.Find(*Clients[Index]))
+			{
+				Errors[Index] = Failure->Error;
+				continue;
+			}
+
+			Errors[Index] = CheckConnection(*Clients[Index], URL);
+			bAllDone &= Errors[Index] == EScopedGameConnectError::Success;
+		}
+
+		return bAllDone;
+	});
+
+	for (int32 Index = 0; Index < NumClients; ++Index)
+	{
+		if (Clients[Index] && Errors[Index] != EScopedGameConnectError::Success)
+		{
+			if (const auto* Failure = FailureWatcher.Find(*Clients[Index]))
+			{
+				ensureAlwaysMsgf(false, TEXT("Failed connecting client %d to dedicated server: %s: %s"), Index, *ToString(Failure->Error), *Failure->Reason);
+			}
+			else
+			{
+				ensureAlwaysMsgf(false, TEXT("Timeout connecting client %d to dedicated server: %s"), Index, *ToString(Errors[Index]));
+			}
+
+			DestroyGame(Clients[Index]);
+			Clients[Index] = nullptr;
+		}
+	}
+
+	if (OutErrors)
+	{
+		*OutErrors = MoveTemp(Errors);
+	}
+
+	return Clients;
+}
+
+void FScopedGameInstance::EndPlayAndShutdownNetDriver(UGameInstance& Game)
+{
+	auto* World = Game.GetWorld();
+
+#if UE_VERSION_OLDER_THAN(5, 3, 0)
+	World->BeginTearingDown();
+
+	for (FActorIterator ActorIt(World); ActorIt; ++ActorIt)
+	{
+		ActorIt->RouteEndPlay(EEndPlayReason::EndPlayInEditor);
+	}
+#else
+	World->EndPlay(EEndPlayReason::EndPlayInEditor);
+#endif
+
+	Game.GetEngine()->ShutdownWorldNetDriver(World);
+}
 
 void FScopedGameInstance::DestroyGameInternal(UGameInstance& Game)
 {
 	const auto OnlineSubsystemId = UOnlineEngineInterface::Get()->GetOnlineIdentifier(*Game.GetWorldContext());
 	const auto World = Game.GetWorld();
 
-	// This is an equivalent of UEngine::CleanupGameViewport, but for a single GameInstance
+	PendingGarbagePIEInstances.Add(Game.GetWorldContext()->PIEInstance);
+	TrackWorldPackages(*World);
+	++NumGamesDestroyedSinceCollection;
+
+	// This is an equivalent of UEngine::CleanupGameViewport, but for a single GameInstance
+	{
+		Game.CleanupGameViewport();
+		if (auto* GameViewport = Game.GetGameViewportClient())
+		{
+			GameViewport->DetachViewportClient();
+		}
+	}
+
+	EndPlayAndShutdownNetDriver(Game);
+
+	Game.Shutdown();
+	World->DestroyWorld(true);
+	GEngine->DestroyWorldContext(World);
+
+	if (auto* OnlineEngineInterface = UOnlineEngineInterface::Get())
+	{
+		if (OnlineEngineInterface->DoesInstanceExist(OnlineSubsystemId))
+		{
+			OnlineEngineInterface->DestroyOnlineSubsystem(OnlineSubsystemId);
+		}
+	}
+}
+
+EScopedGameType FScopedGameInstance::GetGameType(const UGameInstance& Game)
+{
+	const auto* WorldContext = Game.GetWorldContext();
+	if (WorldContext->RunAsDedicated)
+	{
+		return EScopedGameType::Server;
+	}
+
+	if (WorldContext->GameViewport)
+	{
+		return EScopedGameType::Client;
+	}
+
+	return Game.GetNumLocalPlayers() > 0 ? EScopedGameType::HeadlessClient : EScopedGameType::Empty;
+}
+
+void FScopedGameInstance::ReleaseGameToPool(UGameInstance& Game)
+{
+	auto& WorldContext = *Game.GetWorldContext();
+
+	PendingGarbagePIEInstances.Add(WorldContext.PIEInstance);
+	TrackWorldPackages(*Game.GetWorld());
+
+	Game.GetEngine()->CancelPending(WorldContext);
+
+	EndPlayAndShutdownNetDriver(Game);
+
+	// PlayerControllers die together with their world, but local players stay with game instance
+	for (auto* LocalPlayer : Game.GetLocalPlayers())
+	{
+		LocalPlayer->PlayerController = nullptr;
+	}
+
+	// Replace loaded world with an empty one, just like IUESTGameInstance::DefaultInitializeForTests does.
+	// It will be replaced by UEngine::LoadMap when game is taken from pool.
+	Game.GetWorld()->DestroyWorld(false);
+
+	auto* DummyWorld = UWorld::CreateWorld(WorldContext.WorldType, true);
+	DummyWorld->SetGameInstance(&Game);
+	WorldContext.SetCurrentWorld(DummyWorld);
+
+	Game.AddToRoot();
+	GamePool.Emplace(&Game);
+	RegisterAutomationCleanup();
+}
+
+void FScopedGameInstance::DestroyOrReleaseGame(UGameInstance& Game) const
+{
+	if (bUsePooling)
+	{
+		ReleaseGameToPool(Game);
+	}
+	else
+	{
+		DestroyGameInternal(Game);
+	}
+}
+
+void FScopedGameInstance::DrainGamePool()
+{
+	const bool bCollectGarbage = !GamePool.IsEmpty();
+
+	for (const auto& PooledGame : GamePool)
+	{
+		if (auto* Game = PooledGame.Get())
+		{
+			Game->RemoveFromRoot();
+			DestroyGameInternal(*Game);
+		}
+	}
+
+	GamePool.Empty();
+
+	if (bCollectGarbage)
+	{
+		CollectGarbage();
+	}
+}
+
+bool FScopedGameInstance::DestroyGame(UGameInstance* Game)
+{
+	if (!Game)
+	{
+		return false;
+	}
+
+	for (int32 Index = 0; Index < Games.Num(); ++Index)
+	{
+		if (Games[Index].Get() != Game)
+		{
+			continue;
+		}
+
+		if (const auto* World = Game->GetWorld())
+		{
+			ObjectMaps.RemoveAll([&](const auto& ObjectMap) { return ObjectMap->Involves(*World); });
+		}
+
+		DestroyOrReleaseGame(*Game);
+		Games.RemoveAt(Index);
+		GameTickStates.Remove(Game);
+		if (TickProfile)
+		{
+			TickProfile->RemoveGame(*Game);
+		}
+
+		if (GCPolicy.Timing == EScopedGameGCTiming::AfterEachDestroy && NumGamesDestroyedSinceCollection > 0)
+		{
+			CollectGarbage(GCPolicy.StaleWorldCheckInterval);
+		}
+
+		return true;
+	}
+
+	return ensureMsgf(false, TEXT("Game %s was not registered"), *Game->GetPathName());
+}
+
+void FScopedGameInstance::TickInternal(const float DeltaSeconds, const ELevelTick TickType, const TSet<const UGameInstance*>* GameFilter)
+{
+	// Unfortunately, there are issues with this helper
+	// CommandletHelpers::TickEngine(nullptr, CurrentStep);
+
+	if (bUseVirtualTime)
+	{
+		// Systems that use FApp time observe simulated time instead of wall-clock time
+		FApp::UpdateLastTime();
+		FApp::SetCurrentTime(FApp::GetCurrentTime() + DeltaSeconds);
+		FApp::SetDeltaTime(DeltaSeconds);
+	}
+
+	NetStatsSeconds += DeltaSeconds;
+
+	auto* FrameProfile = TickProfile ? &TickProfile->AddFrame() : nullptr;
+	const auto FrameStartTime = FPlatformTime::Seconds();
+
+	++GFrameCounter;
+	StaticTick(DeltaSeconds);
+	FTSTicker::GetCoreTicker().Tick(DeltaSeconds);
+
+	const auto bBlockOnStreaming = StreamingSettings.Mode == EScopedGameStreamingMode::Blocking;
+	if (!bBlockOnStreaming)
+	{
+		// Async loading is process-wide, so it is processed once per frame for all games
+		const auto AsyncLoadingStartTime = FPlatformTime::Seconds();
+		ProcessAsyncLoading(true, false, StreamingSettings.BudgetSeconds);
+
+		if (FrameProfile)
+		{
+			FrameProfile->AsyncLoadingSeconds = FPlatformTime::Seconds() - AsyncLoadingStartTime;
+		}
+	}
+
+	if (FrameProfile)
+	{
+		FrameProfile->FrameCounter = GFrameCounter;
+		FrameProfile->DeltaSeconds = DeltaSeconds;
+		FrameProfile->EngineTickSeconds = FPlatformTime::Seconds() - FrameStartTime;
+	}
+
+	// Games cannot be ticked in parallel, even if their worlds share no state:
+	// - UWorld::Tick drives the process-wide FTickTaskManagerInterface singleton and checks IsInGameThread() in many places
+	// - GWorld, GPlayInEditorID and GIsPlayInEditorWorld are plain globals that world code reads during tick
+	// - Actor spawning, UObject creation and async loading flush expect to be called from the game thread
+	for (const auto& Game : Games)
+	{
+		if (GameFilter && !GameFilter->Contains(Game.Get()))
+		{
+			continue;
+		}
+
+		auto GameDeltaSeconds = DeltaSeconds;
+		if (auto* TickState = GameTickStates.Find(Game.Get()))
+		{
+			if (TickState->bFrozen)
+			{
+				continue;
+			}
+
+			// Accumulated steps are not exact, 5 steps of 0.1 have to be enough for 0.5 interval
+			TickState->AccumulatedSeconds += DeltaSeconds;
+			if (TickState->AccumulatedSeconds < TickState->IntervalSeconds - UE_KINDA_SMALL_NUMBER)
+			{
+				continue;
+			}
+
+			GameDeltaSeconds = TickState->AccumulatedSeconds;
+			TickState->AccumulatedSeconds = 0;
+		}
+
+		const TGuardValue GIsPlayInEditorWorldGuard(GIsPlayInEditorWorld, false);
+		const FGPlayInEditorIDGuard GPlayInEditorIDGuard(Game->GetWorldContext()->PIEInstance);
+		const FGWorldGuard GWorldGuard;
+
+		FScopedGameFrameProfile::FPhaseSeconds* PhaseSeconds = nullptr;
+		FScopedGameFrameProfile::FTickGroupSeconds* TickGroupSeconds = nullptr;
+		if (const auto GameIndex = FrameProfile ? TickProfile->FindGameIndex(*Game) : INDEX_NONE; FrameProfile && FrameProfile->GamePhaseSeconds.IsValidIndex(GameIndex))
+		{
+			PhaseSeconds = &FrameProfile->GamePhaseSeconds[GameIndex];
+			TickGroupSeconds = &FrameProfile->GameTickGroupSeconds[GameIndex];
+			FrameProfile->TickedGames[GameIndex] = true;
+		}
+
+		auto PhaseStartTime = FPlatformTime::Seconds();
+		const auto EndPhase = [&](const EScopedGameTickPhase Phase) {
+			if (PhaseSeconds)
+			{
+				const auto Now = FPlatformTime::Seconds();
+				(*PhaseSeconds)[static_cast<int32>(Phase)] = Now - PhaseStartTime;
+				PhaseStartTime = Now;
+			}
+		};
+
+		Game->GetEngine()->TickWorldTravel(*Game->GetWorldContext(), GameDeltaSeconds);
+		EndPhase(EScopedGameTickPhase::WorldTravel);
+
+		if (auto* World = Game->GetWorld(); bBlockOnStreaming || World->bRequestedBlockOnAsyncLoading)
+		{
+			World->BlockTillLevelStreamingCompleted();
+		}
+		else
+		{
+			World->UpdateLevelStreaming();
+		}
+		EndPhase(EScopedGameTickPhase::LevelStreaming);
+
+		{
+			// AWorldSettings::FixupDeltaSeconds would clamp large steps and accumulated tick intervals, so simulated time would be lost
+			auto* WorldSettings = Game->GetWorld()->GetWorldSettings();
+			const TGuardValue MaxUndilatedFrameTimeGuard(WorldSettings->MaxUndilatedFrameTime, FMath::Max(WorldSettings->MaxUndilatedFrameTime, GameDeltaSeconds));
+
+			TOptional<FTickGroupMarkers> TickGroupMarkers;
+			if (TickGroupSeconds)
+			{
+				TickGroupMarkers.Emplace(*Game->GetWorld());
+			}
+
+			Game->GetWorld()->Tick(TickType, GameDeltaSeconds);
+
+			if (TickGroupMarkers)
+			{
+				TickGroupMarkers->GetTickGroupSeconds(*TickGroupSeconds, FPlatformTime::Seconds());
+			}
+		}
+		EndPhase(EScopedGameTickPhase::WorldTick);
+	}
+
+	if (FrameProfile)
+	{
+		FrameProfile->TotalSeconds = FPlatformTime::Seconds() - FrameStartTime;
+	}
+}
+
+UObject* FScopedGameInstance::StaticFindReplicatedObjectIn(UObject* Object, const UWorld* World)
+{
+	if (!ensure(World) || !Object)
+	{
+		return nullptr;
+	}
+	if (Object->GetWorld() == World)
+	{
+		return Object;
+	}
+
+	const auto TheirNetDriver = Object->GetWorld()->GetNetDriver();
+
+#if UE_WITH_IRIS
+	if (const auto TheirReplicationSystem = TheirNetDriver->GetReplicationSystem())
+	{
+		const auto TheirObjectBridge = Cast<UObjectReplicationBridge>(TheirReplicationSystem->GetReplicationBridge());
+		if (!TheirObjectBridge)
+		{
+			return nullptr;
+		}
+
+		const auto ObjectRefHandle = TheirObjectBridge->GetReplicatedRefHandle(Object);
+		if (!ObjectRefHandle.IsValid())
+		{
+			return nullptr;
+		}
+
+		auto* OurNetDriver = World->GetNetDriver();
+		if (!OurNetDriver)
+		{
+			return nullptr;
+		}
+
+		const auto WorldReplicationSystem = OurNetDriver->GetReplicationSystem();
+		if (!WorldReplicationSystem)
+		{
+			return nullptr;
+		}
+
+		if (const auto OurObjectBridge = Cast<UObjectReplicationBridge>(WorldReplicationSystem->GetReplicationBridge()))
+		{
+			return OurObjectBridge->GetReplicatedObject(ObjectRefHandle);
+		}
+	}
+	else
+#endif
+	{
+		const auto* OurNetDriver = World->GetNetDriver();
+		if (!OurNetDriver)
+		{
+			return nullptr;
+		}
+
+		const FNetworkGUID* GUID = TheirNetDriver->GuidCache->NetGUIDLookup.Find(Object);
+		if (!GUID)
+		{
+			return nullptr;
+		}
+
+		const auto* ObjectRef = OurNetDriver->GuidCache->ObjectLookup.Find(*GUID);
+		return ObjectRef ? ObjectRef->Object.Get() : nullptr;
+	}
+
+	return nullptr;
+}
+
+static int32 GetNumNetGUIDs(const UWorld* World)
+{
+	const auto* NetDriver = World ? World->GetNetDriver() : nullptr;
+	return NetDriver && NetDriver->GuidCache ? NetDriver->GuidCache->ObjectLookup.Num() : 0;
+}
+
+FScopedGameObjectMap::FScopedGameObjectMap(UWorld& From, UWorld& To)
+    : From{&From}
+    , To{&To}
+{
+	for (TActorIterator<AActor> It{&From}; It; ++It)
+	{
+		if (It->GetIsReplicated())
+		{
+			Pending.Add(*It);
+		}
+	}
+
+	FromSpawnedHandle = From.AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateRaw(this, &FScopedGameObjectMap::OnFromActorSpawned));
+	FromDestroyedHandle = From.AddOnActorDestroyedHandler(FOnActorDestroyed::FDelegate::CreateRaw(this, &FScopedGameObjectMap::OnFromActorDestroyed));
+	ToSpawnedHandle = To.AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateRaw(this, &FScopedGameObjectMap::OnToActorSpawned));
+	ToDestroyedHandle = To.AddOnActorDestroyedHandler(FOnActorDestroyed::FDelegate::CreateRaw(this, &FScopedGameObjectMap::OnToActorDestroyed));
+}
+
+FScopedGameObjectMap::~FScopedGameObjectMap()
+{
+	if (auto* FromWorld = From.Get())
+	{
+		FromWorld->RemoveOnActorSpawnedHandler(FromSpawnedHandle);
+		FromWorld->RemoveOnActorDestroyedHandler(FromDestroyedHandle);
+	}
+
+	if (auto* ToWorld = To.Get())
+	{
+		ToWorld->RemoveOnActorSpawnedHandler(ToSpawnedHandle);
+		ToWorld->RemoveOnActorDestroyedHandler(ToDestroyedHandle);
+	}
+}
+
+bool FScopedGameObjectMap::Involves(const UWorld& World) const
+{
+	return From.Get() == &World || To.Get() == &World;
+}
+
+bool FScopedGameObjectMap::Maps(const UWorld& InFrom, const UWorld& InTo) const
+{
+	return From.Get() == &InFrom && To.Get() == &InTo;
+}
+
+void FScopedGameObjectMap::OnFromActorSpawned(AActor* Actor)
+{
+	if (Actor && Actor->GetIsReplicated())
+	{
+		Pending.Add(Actor);
+		bPendingDirty = true;
+	}
+}
+
+void FScopedGameObjectMap::OnFromActorDestroyed(AActor* Actor)
+{
+	Pending.Remove(Actor);
+
+	TWeakObjectPtr<UObject> Counterpart;
+	if (FromToTo.RemoveAndCopyValue(Actor, Counterpart))
+	{
+		ToToFrom.Remove(Counterpart);
+	}
+}
+
+void FScopedGameObjectMap::OnToActorSpawned(AActor* Actor)
+{
+	// Net GUID is assigned after actor is spawned, so it is resolved during next update rather than right away
+	bPendingDirty = true;
+}
+
+void FScopedGameObjectMap::OnToActorDestroyed(AActor* Actor)
+{
+	TWeakObjectPtr<UObject> Counterpart;
+	if (ToToFrom.RemoveAndCopyValue(Actor, Counterpart))
+	{
+		FromToTo.Remove(Counterpart);
+
+		// Actor may come back when it becomes relevant again
+		if (auto* CounterpartActor = Cast<AActor>(Counterpart.Get()); CounterpartActor && !CounterpartActor->IsActorBeingDestroyed())
+		{
+			Pending.Add(CounterpartActor);
+		}
+	}
+}
+
+void FScopedGameObjectMap::Update()
+{
+	auto* ToWorld = To.Get();
+	if (!ToWorld || Pending.IsEmpty())
+	{
+		return;
+	}
+
+	// Iris does not expose a cheap way to see that new objects were mapped, so pending actors are retried on every update
+	const auto* ToNetDriver = ToWorld->GetNetDriver();
+	const auto NumGUIDs = GetNumNetGUIDs(ToWorld);
+	if (!bPendingDirty && NumGUIDs == LastNumGUIDs && !(ToNetDriver && ToNetDriver->IsUsingIrisReplication()))
 	{
-		Game.CleanupGameViewport();
-		if (auto* GameViewport = Game.GetGameViewportClient())
+		return;
+	}
+
+	bPendingDirty = false;
+	LastNumGUIDs = NumGUIDs;
+
+	for (auto It = Pending.CreateIterator(); It; ++It)
+	{
+		auto* Actor = It->Get();
+		if (!Actor)
 		{
-			GameViewport->DetachViewportClient();
+			It.RemoveCurrent();
+			continue;
+		}
+
+		if (auto* Counterpart = FScopedGameInstance::StaticFindReplicatedObjectIn(Actor, ToWorld))
+		{
+			FromToTo.Add(Actor, Counterpart);
+			ToToFrom.Add(Counterpart, Actor);
+			It.RemoveCurrent();
 		}
 	}
+}
 
-#if UE_VERSION_OLDER_THAN(5, 3, 0)
-	World->BeginTearingDown();
+UObject* FScopedGameObjectMap::Find(const UObject* Object)
+{
+	if (!Object)
+	{
+		return nullptr;
+	}
 
-	for (FActorIterator ActorIt(World); ActorIt; ++ActorIt)
+	if (!Object->IsA<AActor>())
 	{
-		ActorIt->RouteEndPlay(EEndPlayReason::EndPlayInEditor);
+		return FScopedGameInstance::StaticFindReplicatedObjectIn(const_cast<UObject*>(Object), To.Get());
 	}
-#else
-	World->EndPlay(EEndPlayReason::EndPlayInEditor);
-#endif
 
-	Game.GetEngine()->ShutdownWorldNetDriver(World);
+	Update();
+	return FromToTo.FindRef(Object).Get();
+}
 
-	Game.Shutdown();
-	World->DestroyWorld(true);
-	GEngine->DestroyWorldContext(World);
+UObject* FScopedGameObjectMap::FindReverse(const UObject* Object)
+{
+	if (!Object)
+	{
+		return nullptr;
+	}
 
-	if (auto* OnlineEngineInterface = UOnlineEngineInterface::Get())
+	if (!Object->IsA<AActor>())
 	{
-		if (OnlineEngineInterface->DoesInstanceExist(OnlineSubsystemId))
+		return FScopedGameInstance::StaticFindReplicatedObjectIn(const_cast<UObject*>(Object), From.Get());
+	}
+
+	Update();
+	return ToToFrom.FindRef(Object).Get();
+}
+
+const TMap<TWeakObjectPtr<const UObject>, TWeakObjectPtr<UObject>>& FScopedGameObjectMap::GetPairs()
+{
+	Update();
+	return FromToTo;
+}
+
+int32 FScopedGameObjectMap::Num()
+{
+	Update();
+	return FromToTo.Num();
+}
+
+void FScopedGameInstance::SaveCheckpoint()
+{
+	Checkpoints.Empty(Games.Num());
+
+	for (const auto& Game : Games)
+	{
+		if (auto* World = Game->GetWorld())
 		{
-			OnlineEngineInterface->DestroyOnlineSubsystem(OnlineSubsystemId);
+			Checkpoints.Emplace(*World);
 		}
 	}
 }
 
-bool FScopedGameInstance::DestroyGame(UGameInstance* Game)
+bool FScopedGameInstance::RestoreCheckpoint()
 {
-	if (!Game)
+	if (!ensureAlwaysMsgf(!Checkpoints.IsEmpty(), TEXT("There is no checkpoint to restore, call SaveCheckpoint first")))
 	{
 		return false;
 	}
 
-	for (int32 Index = 0; Index < Games.Num(); ++Index)
+	auto bSuccess = true;
+	for (auto& Checkpoint : Checkpoints)
 	{
-		if (Games[Index].Get() != Game)
+		// Games destroyed since checkpoint are simply skipped
+		if (Checkpoint.IsValid())
 		{
-			continue;
+			bSuccess &= Checkpoint.Restore();
 		}
+	}
 
-		DestroyGameInternal(*Game);
-		Games.RemoveAt(Index);
+	return bSuccess;
+}
 
-		CollectGarbage();
+FScopedGameObjectMapHandle FScopedGameInstance::MapReplicatedObjects(UWorld& From, UWorld& To)
+{
+	for (const auto& ObjectMap : ObjectMaps)
+	{
+		if (ObjectMap->Maps(From, To))
+		{
+			return FScopedGameObjectMapHandle{ObjectMap};
+		}
+	}
+
+	return FScopedGameObjectMapHandle{ObjectMaps.Add_GetRef(MakeShared<FScopedGameObjectMap>(From, To))};
+}
+
+bool FScopedGameInstance::IsGarbageCollectionDueAtScopeEnd() const
+{
+	if (GCPolicy.ScopeInterval > 0 && NumScopesSinceCollection >= GCPolicy.ScopeInterval)
+	{
 		return true;
 	}
 
-	return ensureMsgf(false, TEXT("Game %s was not registered"), *Game->GetPathName());
+	if (GCPolicy.MemoryThresholdMB > 0)
+	{
+		const auto UsedPhysicalMB = FPlatformMemory::GetStats().UsedPhysical / (1024 * 1024);
+		return UsedPhysicalMB >= GCPolicy.MemoryThresholdMB;
+	}
+
+	return false;
 }
 
-void FScopedGameInstance::TickInternal(const float DeltaSeconds, const ELevelTick TickType)
+void FScopedGameInstance::CollectGarbage(const int32 StaleWorldCheckInterval)
 {
-	// Unfortunately, there are issues with this helper
-	// CommandletHelpers::TickEngine(nullptr, CurrentStep);
+	{
+		const FScopeLock Lock{&PIEPackageNamesCriticalSection};
+		for (const auto PIEInstance : PendingGarbagePIEInstances)
+		{
+			TSet<FName> PackageNames;
+			PIEPackageNames.RemoveAndCopyValue(PIEInstance, PackageNames);
 
-	++GFrameCounter;
-	StaticTick(DeltaSeconds);
-	FTSTicker::GetCoreTicker().Tick(DeltaSeconds);
+			for (const auto PackageName : PackageNames)
+			{
+				if (auto* Package = FindObjectFast<UPackage>(nullptr, PackageName))
+				{
+					PendingGarbagePackages.Add(Package);
+				}
+			}
+		}
+	}
 
-	for (const auto& Game : Games)
+	// find objects like Textures in the playworld levels that won't get garbage collected as they are marked RF_Standalone
+	// Only look into packages of worlds we destroyed instead of iterating over all objects in the engine
+	for (const auto& WeakPackage : PendingGarbagePackages)
 	{
-		const TGuardValue GIsPlayInEditorWorldGuard(GIsPlayInEditorWorld, false);
-		const FGPlayInEditorIDGuard GPlayInEditorIDGuard(Game->GetWorldContext()->PIEInstance);
-		const FGWorldGuard GWorldGuard;
+		const auto* Package = WeakPackage.Get();
+		if (!Package || !Package->HasAnyPackageFlags(PKG_PlayInEditor))
+		{
+			continue;
+		}
 
-		Game->GetEngine()->TickWorldTravel(*Game->GetWorldContext(), DeltaSeconds);
-		// TODO: Can this BlockTillLevelStreamingCompleted be replaced with ProcessAsyncLoading?
-		Game->GetWorld()->BlockTillLevelStreamingCompleted();
-		Game->GetWorld()->Tick(TickType, DeltaSeconds);
+		ForEachObjectWithPackage(Package, [](UObject* Object) {
+			// Clear RF_Standalone flag from objects in the levels used for PIE so they get cleaned up.
+			Object->ClearFlags(RF_Standalone);
+			return true;
+		});
+	}
+
+	PendingGarbagePackages.Empty();
+
+	::CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	PendingGarbagePIEInstances.Empty();
+	NumGamesDestroyedSinceCollection = 0;
+	NumScopesSinceCollection = 0;
+
+	if (++NumCollectionsSinceStaleWorldCheck >= StaleWorldCheckInterval)
+	{
+		NumCollectionsSinceStaleWorldCheck = 0;
+		GEngine->CheckAndHandleStaleWorldObjectReferences();
 	}
 }
 
-UObject* FScopedGameInstance::StaticFindReplicatedObjectIn(UObject* Object, const UWorld* World)
+void FScopedGameInstance::TickInSteps(const float DeltaSeconds, const float StepSeconds, const ELevelTick TickType, const TSet<const UGameInstance*>* GameFilter)
 {
-	if (!ensure(World) || !Object)
+	if (!ensureMsgf(StepSeconds > 0, TEXT("Tick step must be positive: %f"), StepSeconds))
 	{
-		return nullptr;
+		return;
 	}
-	if (Object->GetWorld() == World)
+
+	auto RemainingTickTime = DeltaSeconds;
+	while (RemainingTickTime >= 0)
 	{
-		return Object;
+		const float CurrentStep = FMath::Min(RemainingTickTime, StepSeconds);
+		TickInternal(CurrentStep, TickType, GameFilter);
+		RemainingTickTime -= StepSeconds;
 	}
+}
 
-	const auto TheirNetDriver = Object->GetWorld()->GetNetDriver();
+void FScopedGameInstance::Tick(const float DeltaSeconds, const float StepSeconds, const ELevelTick TickType)
+{
+	TickInSteps(DeltaSeconds, StepSeconds, TickType, nullptr);
+}
 
-#if UE_WITH_IRIS
-	if (const auto TheirReplicationSystem = TheirNetDriver->GetReplicationSystem())
+void FScopedGameInstance::TickOnly(const TConstArrayView<const UGameInstance*> GamesToTick, const float DeltaSeconds, const float StepSeconds, const ELevelTick TickType)
+{
+	TSet<const UGameInstance*> GameFilter;
+	GameFilter.Append(GamesToTick);
+
+	TickInSteps(DeltaSeconds, StepSeconds, TickType, &GameFilter);
+}
+
+void FScopedGameInstance::SetTickInterval(const UGameInstance& Game, const float IntervalSeconds)
+{
+	if (ensureMsgf(IntervalSeconds >= 0, TEXT("Tick interval must not be negative: %f"), IntervalSeconds))
 	{
-		const auto TheirObjectBridge = Cast<UObjectReplicationBridge>(TheirReplicationSystem->GetReplicationBridge());
-		if (!TheirObjectBridge)
-		{
-			return nullptr;
-		}
+		GameTickStates.FindOrAdd(&Game).IntervalSeconds = IntervalSeconds;
+	}
+}
 
-		const auto ObjectRefHandle = TheirObjectBridge->GetReplicatedRefHandle(Object);
-		if (!ObjectRefHandle.IsValid())
-		{
-			return nullptr;
-		}
+const FScopedGameTickProfile* FScopedGameInstance::GetTickProfile() const
+{
+	return TickProfile.GetPtrOrNull();
+}
 
-		auto* OurNetDriver = World->GetNetDriver();
-		if (!OurNetDriver)
-		{
-			return nullptr;
-		}
+FScopedGameTickStats FScopedGameInstance::TickStats(const UGameInstance& Game) const
+{
+	if (!ensureAlwaysMsgf(TickProfile, TEXT("Tick stats require tick profiler, use FScopedGame::WithTickProfiler")))
+	{
+		return {};
+	}
 
-		const auto WorldReplicationSystem = OurNetDriver->GetReplicationSystem();
-		if (!WorldReplicationSystem)
-		{
-			return nullptr;
-		}
+	return TickProfile->GetGameStats(Game);
+}
 
-		if (const auto OurObjectBridge = Cast<UObjectReplicationBridge>(WorldReplicationSystem->GetReplicationBridge()))
-		{
-			return OurObjectBridge->GetReplicatedObject(ObjectRefHandle);
-		}
+static FScopedGameNetStats GetConnectionTotals(const UNetConnection& Connection)
+{
+	FScopedGameNetStats Result;
+	Result.InBytes = Connection.InTotalBytes;
+	Result.OutBytes = Connection.OutTotalBytes;
+	Result.InPackets = Connection.InTotalPackets;
+	Result.OutPackets = Connection.OutTotalPackets;
+	return Result;
+}
+
+static TArray<const UNetConnection*> GetConnections(const UGameInstance& Game)
+{
+	TArray<const UNetConnection*> Result;
+
+	const auto* World = Game.GetWorld();
+	const auto* NetDriver = World ? World->GetNetDriver() : nullptr;
+	if (NetDriver == nullptr)
+	{
+		return Result;
 	}
-	else
-#endif
+
+	if (NetDriver->ServerConnection)
 	{
-		const auto* OurNetDriver = World->GetNetDriver();
-		if (!OurNetDriver)
-		{
-			return nullptr;
-		}
+		Result.Add(NetDriver->ServerConnection);
+	}
 
-		const FNetworkGUID* GUID = TheirNetDriver->GuidCache->NetGUIDLookup.Find(Object);
-		if (!GUID)
+	for (const auto& Connection : NetDriver->ClientConnections)
+	{
+		if (Connection)
 		{
-			return nullptr;
+			Result.Add(Connection);
 		}
-
-		const auto* ObjectRef = OurNetDriver->GuidCache->ObjectLookup.Find(*GUID);
-		return ObjectRef ? ObjectRef->Object.Get() : nullptr;
 	}
 
-	return nullptr;
+	return Result;
 }
 
-void FScopedGameInstance::CollectGarbage()
+FScopedGameNetStats FScopedGameInstance::GetConnectionNetStats(const UNetConnection& Connection) const
 {
-	// find objects like Textures in the playworld levels that won't get garbage collected as they are marked RF_Standalone
-	for (FThreadSafeObjectIterator It; It; ++It)
+	auto Result = GetConnectionTotals(Connection);
+	if (const auto* Baseline = NetStatsBaselines.Find(&Connection))
 	{
-		UObject* Object = *It;
+		Result -= *Baseline;
+	}
+
+	Result.Seconds = NetStatsSeconds;
+	return Result;
+}
+
+void FScopedGameInstance::ResetNetStats()
+{
+	NetStatsBaselines.Empty();
+	NetStatsSeconds = 0;
 
-		if (Object->GetOutermost()->HasAnyPackageFlags(PKG_PlayInEditor))
+	for (const auto& Game : Games)
+	{
+		for (const auto* Connection : GetConnections(*Game))
 		{
-			if (Object->HasAnyFlags(RF_Standalone))
-			{
-				// Clear RF_Standalone flag from objects in the levels used for PIE so they get cleaned up.
-				Object->ClearFlags(RF_Standalone);
-			}
+			NetStatsBaselines.Add(Connection, GetConnectionTotals(*Connection));
 		}
 	}
+}
 
-	::CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
-	GEngine->CheckAndHandleStaleWorldObjectReferences();
+FScopedGameNetStats FScopedGameInstance::NetStats(const UGameInstance& Game) const
+{
+	FScopedGameNetStats Result;
+	for (const auto* Connection : GetConnections(Game))
+	{
+		Result += GetConnectionNetStats(*Connection);
+	}
+
+	Result.Seconds = NetStatsSeconds;
+	return Result;
 }
 
-void FScopedGameInstance::Tick(const float DeltaSeconds, const float StepSeconds, const ELevelTick TickType)
+FScopedGameNetStats FScopedGameInstance::NetStats(const UGameInstance& Server, const UGameInstance& Client) const
 {
-	if (!ensureMsgf(StepSeconds > 0, TEXT("Tick step must be positive: %f"), StepSeconds))
+	// Connections are matched by player id because addresses differ between net drivers
+	const auto* ClientController = Client.GetWorld() ? Client.GetWorld()->GetFirstPlayerController() : nullptr;
+	if (!ensureAlwaysMsgf(ClientController && ClientController->PlayerState, TEXT("Client %s has no replicated player state"), *Client.GetName()))
 	{
-		return;
+		return {};
 	}
 
-	auto RemainingTickTime = DeltaSeconds;
-	while (RemainingTickTime >= 0)
+	for (const auto* Connection : GetConnections(Server))
 	{
-		const float CurrentStep = FMath::Min(RemainingTickTime, StepSeconds);
-		TickInternal(CurrentStep, TickType);
-		RemainingTickTime -= StepSeconds;
+		if (Connection->PlayerController && Connection->PlayerController->PlayerState && Connection->PlayerController->PlayerState->GetPlayerId() == ClientController->PlayerState->GetPlayerId())
+		{
+			return GetConnectionNetStats(*Connection);
+		}
 	}
+
+	ensureAlwaysMsgf(false, TEXT("Client %s is not connected to server %s"), *Client.GetName(), *Server.GetName());
+	return {};
+}
+
+void FScopedGameInstance::SetFrozen(const UGameInstance& Game, const bool bFrozen)
+{
+	GameTickStates.FindOrAdd(&Game).bFrozen = bFrozen;
 }
 
 bool FScopedGameInstance::TickUntil(const TFunctionRef<bool()>& Condition, const float StepSeconds, const float MaxWaitTime, ELevelTick TickType)
@@ -529,6 +1823,29 @@ bool FScopedGameInstance::TickUntil(const TFunctionRef<bool()>& Condition, const
 	return Condition();
 }
 
+bool FScopedGameInstance::TickUntilStreamingComplete(const float StepSeconds, const float MaxWaitTime, const ELevelTick TickType)
+{
+	return TickUntil(
+	    [&] {
+		    if (IsAsyncLoading())
+		    {
+			    return false;
+		    }
+
+		    for (const auto& Game : Games)
+		    {
+			    const auto* World = Game->GetWorld();
+			    if (World->HasStreamingLevelsToConsider() || World->IsVisibilityRequestPending())
+			    {
+				    return false;
+			    }
+		    }
+
+		    return true;
+	    },
+	    StepSeconds, MaxWaitTime, TickType);
+}
+
 FScopedGame::FScopedGame()
     : WorldType{WITH_EDITOR ? EWorldType::PIE : EWorldType::Game}
 {
@@ -572,7 +1889,62 @@ FScopedGame& FScopedGame::WithConsoleVariable(const FString& Name, FString Value
 	return *this;
 }
 
+FScopedGame& FScopedGame::WithMapTemplateCache(const bool bEnable)
+{
+	bUseMapTemplateCache = bEnable;
+	return *this;
+}
+
+FScopedGame& FScopedGame::WithPooling(const bool bEnable)
+{
+	bUsePooling = bEnable;
+	return *this;
+}
+
+FScopedGame& FScopedGame::WithGarbageCollectionPolicy(const FScopedGameGCPolicy& InGCPolicy)
+{
+	GCPolicy = InGCPolicy;
+
+	// Destroyed games would never be collected, and their PIE instances would never be reused
+	if (!ensureAlwaysMsgf(GCPolicy.ScopeInterval > 0 || GCPolicy.MemoryThresholdMB > 0, TEXT("ScopeInterval of zero requires MemoryThresholdMB, collecting at every scope end instead")))
+	{
+		GCPolicy.ScopeInterval = 1;
+	}
+
+	return *this;
+}
+
+FScopedGame& FScopedGame::WithVirtualTime(const bool bEnable)
+{
+	bUseVirtualTime = bEnable;
+	return *this;
+}
+
+FScopedGame& FScopedGame::WithTickProfiler(const bool bEnable)
+{
+	bProfileTicks = bEnable;
+	return *this;
+}
+
+FScopedGame& FScopedGame::WithStreamingSettings(const FScopedGameStreamingSettings& InStreamingSettings)
+{
+	StreamingSettings = InStreamingSettings;
+	return *this;
+}
+
+FScopedGame& FScopedGame::WithInMemoryNetworking(const bool bEnable)
+{
+	bUseInMemoryNetworking = bEnable;
+	return *this;
+}
+
+FScopedGame& FScopedGame::WithNetworkEmulation(const FScopedGameNetworkEmulation& InNetworkEmulation)
+{
+	NetworkEmulation = InNetworkEmulation;
+	return *this;
+}
+
 FScopedGameInstance FScopedGame::Create() const
 {
-	return FScopedGameInstance{GameInstanceClass, WorldType, CVars};
+	return FScopedGameInstance{GameInstanceClass, WorldType, CVars, bUseMapTemplateCache, bUsePooling, GCPolicy, bUseVirtualTime, bProfileTicks, StreamingSettings, bUseInMemoryNetworking, NetworkEmulation};
 }
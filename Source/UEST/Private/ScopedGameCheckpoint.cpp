@@ -0,0 +1,282 @@
+#include "ScopedGameCheckpoint.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "EngineUtils.h"
+#include "GameFramework/GameMode.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogUESTCheckpoint, Log, All);
+
+FScopedGameWorldCheckpoint::FScopedGameWorldCheckpoint(UWorld& World)
+    : World{&World}
+{
+	if (const auto* NetDriver = World.GetNetDriver())
+	{
+		for (const auto& Connection : NetDriver->ClientConnections)
+		{
+			Connections.Add(Connection.Get());
+		}
+	}
+
+	for (TActorIterator<AActor> It{&World}; It; ++It)
+	{
+		auto* Actor = *It;
+		if (Actor->IsActorBeingDestroyed() || !ShouldRollBack(*Actor))
+		{
+			continue;
+		}
+
+		auto& State = Actors.AddDefaulted_GetRef();
+		State.Actor = Actor;
+		State.Level = Actor->GetLevel();
+		State.Class = Actor->GetClass();
+		State.Name = Actor->GetFName();
+		State.Transform = Actor->GetActorTransform();
+		State.bNetStartup = Actor->IsNetStartupActor();
+		SaveObject(*Actor, State.Data);
+
+		for (auto* Component : Actor->GetComponents())
+		{
+			if (Component)
+			{
+				auto& ComponentState = State.Components.AddDefaulted_GetRef();
+				ComponentState.Class = Component->GetClass();
+				ComponentState.Name = Component->GetFName();
+				SaveObject(*Component, ComponentState.Data);
+			}
+		}
+	}
+}
+
+bool FScopedGameWorldCheckpoint::ShouldRollBack(const AActor& Actor)
+{
+	return Actor.GetNetMode() != NM_Client || !Actor.GetIsReplicated();
+}
+
+void FScopedGameWorldCheckpoint::SaveObject(UObject& Object, TArray<uint8>& OutData)
+{
+	// Non-persistent archive, so transient properties are saved too
+	FMemoryWriter Writer{OutData, false};
+	FObjectAndNameAsStringProxyArchive Archive{Writer, false};
+	Object.Serialize(Archive);
+}
+
+void FScopedGameWorldCheckpoint::LoadObject(UObject& Object, const TArray<uint8>& Data)
+{
+	FMemoryReader Reader{Data, false};
+	FObjectAndNameAsStringProxyArchive Archive{Reader, false};
+	Object.Serialize(Archive);
+}
+
+AActor* FScopedGameWorldCheckpoint::Respawn(UWorld& InWorld, const FActorState& State)
+{
+	auto* Level = State.Level.Get();
+	if (!Level || !State.Class)
+	{
+		return nullptr;
+	}
+
+	// Destroyed actor may still be around until garbage is collected, it has to give its name to the new one
+	if (auto* OldActor = FindObjectFast<AActor>(Level, State.Name))
+	{
+		OldActor->Rename(nullptr, GetTransientPackage(), REN_DontCreateRedirectors | REN_NonTransactional | REN_DoNotDirty);
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Name = State.Name;
+	SpawnParameters.OverrideLevel = Level;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParameters.NameMode = FActorSpawnParameters::ESpawnActorNameMode::Required_ErrorAndReturnNull;
+	SpawnParameters.bDeferConstruction = true;
+
+	auto* Actor = InWorld.SpawnActor(State.Class, &State.Transform, SpawnParameters);
+	if (!Actor)
+	{
+		return nullptr;
+	}
+
+	// Spawned actors are never net startup ones, but level-placed actor keeps its stable name, so it has to stay one
+	Actor->bNetStartup = State.bNetStartup;
+	Actor->FinishSpawning(State.Transform);
+	return Actor;
+}
+
+void FScopedGameWorldCheckpoint::RestoreComponents(AActor& Actor, const FActorState& State)
+{
+	TInlineComponentArray<UActorComponent*> Components{&Actor};
+	for (auto* Component : Components)
+	{
+		const auto bKnown = State.Components.ContainsByPredicate([&](const auto& ComponentState) { return ComponentState.Name == Component->GetFName(); });
+		if (!bKnown)
+		{
+			Component->DestroyComponent();
+		}
+	}
+
+	for (const auto& ComponentState : State.Components)
+	{
+		auto* Component = FindObjectFast<UActorComponent>(&Actor, ComponentState.Name);
+		if (Component && !Component->IsBeingDestroyed())
+		{
+			continue;
+		}
+
+		if (!ComponentState.Class)
+		{
+			continue;
+		}
+
+		// Destroyed component may still be around until garbage is collected, it has to give its name to the new one
+		if (Component)
+		{
+			Component->Rename(nullptr, GetTransientPackage(), REN_DontCreateRedirectors | REN_NonTransactional | REN_DoNotDirty);
+		}
+
+		// Instance components are listed by the actor itself, so its restored properties reference the new component by path
+		Actor.AddInstanceComponent(NewObject<UActorComponent>(&Actor, ComponentState.Class, ComponentState.Name));
+	}
+}
+
+void FScopedGameWorldCheckpoint::MergeLivePlayers(UWorld& World)
+{
+	auto* GameMode = World.GetAuthGameMode();
+	auto* GameState = World.GetGameState();
+	if (!GameMode || !GameState)
+	{
+		return;
+	}
+
+	// Restored list still has players that are gone since checkpoint and lacks those that joined after it
+	GameState->PlayerArray.RemoveAll([](const APlayerState* PlayerState) { return !IsValid(PlayerState) || PlayerState->IsActorBeingDestroyed(); });
+	for (TActorIterator<APlayerState> It{&World}; It; ++It)
+	{
+		if (!It->IsActorBeingDestroyed() && !It->IsInactive())
+		{
+			GameState->PlayerArray.AddUnique(*It);
+		}
+	}
+
+	if (auto* CountingGameMode = Cast<AGameMode>(GameMode))
+	{
+		CountingGameMode->NumPlayers = 0;
+		CountingGameMode->NumSpectators = 0;
+		CountingGameMode->NumBots = 0;
+
+		for (const auto* PlayerState : GameState->PlayerArray)
+		{
+			if (PlayerState->IsABot())
+			{
+				++CountingGameMode->NumBots;
+			}
+			else if (PlayerState->IsOnlyASpectator())
+			{
+				++CountingGameMode->NumSpectators;
+			}
+			else if (Cast<APlayerController>(PlayerState->GetOwner()))
+			{
+				++CountingGameMode->NumPlayers;
+			}
+		}
+	}
+}
+
+bool FScopedGameWorldCheckpoint::Restore()
+{
+	auto* CheckpointWorld = World.Get();
+	if (!CheckpointWorld)
+	{
+		return false;
+	}
+
+	TSet<const AActor*> KnownActors;
+	KnownActors.Reserve(Actors.Num());
+	for (const auto& State : Actors)
+	{
+		if (const auto* Actor = State.Actor.Get(); Actor && !Actor->IsActorBeingDestroyed())
+		{
+			KnownActors.Add(Actor);
+		}
+	}
+
+	TArray<AActor*> SpawnedActors;
+	for (TActorIterator<AActor> It{CheckpointWorld}; It; ++It)
+	{
+		if (KnownActors.Contains(*It) || It->IsActorBeingDestroyed() || !ShouldRollBack(**It))
+		{
+			continue;
+		}
+
+		// Player controllers, pawns and other actors of clients that connected after checkpoint belong to them
+		if (const auto* Connection = It->GetNetConnection(); Connection && !Connections.Contains(Connection))
+		{
+			continue;
+		}
+
+		SpawnedActors.Add(*It);
+	}
+
+	for (auto* Actor : SpawnedActors)
+	{
+		Actor->Destroy();
+	}
+
+	// All actors are respawned before any properties are loaded, so references between them resolve by path
+	auto bSuccess = true;
+	const auto bServer = CheckpointWorld->GetNetMode() == NM_DedicatedServer || CheckpointWorld->GetNetMode() == NM_ListenServer;
+	for (auto& State : Actors)
+	{
+		if (const auto* Actor = State.Actor.Get(); Actor && !Actor->IsActorBeingDestroyed())
+		{
+			continue;
+		}
+
+		if (State.bNetStartup && bServer && State.Class && State.Class->GetDefaultObject<AActor>()->GetIsReplicated())
+		{
+			UE_LOG(LogUESTCheckpoint, Error, TEXT("Cannot respawn replicated level-placed actor %s, clients have destroyed their copies of it"), *State.Name.ToString());
+			bSuccess = false;
+			continue;
+		}
+
+		State.Actor = Respawn(*CheckpointWorld, State);
+		if (!State.Actor.IsValid())
+		{
+			UE_LOG(LogUESTCheckpoint, Error, TEXT("Failed to respawn %s of class %s"), *State.Name.ToString(), *GetNameSafe(State.Class));
+			bSuccess = false;
+		}
+	}
+
+	for (const auto& State : Actors)
+	{
+		auto* Actor = State.Actor.Get();
+		if (!Actor)
+		{
+			continue;
+		}
+
+		// Registered components own render and physics state that would not follow properties loaded under them
+		Actor->UnregisterAllComponents();
+		RestoreComponents(*Actor, State);
+
+		LoadObject(*Actor, State.Data);
+
+		for (const auto& ComponentState : State.Components)
+		{
+			if (auto* Component = FindObjectFast<UActorComponent>(Actor, ComponentState.Name))
+			{
+				LoadObject(*Component, ComponentState.Data);
+			}
+		}
+
+		Actor->RegisterAllComponents();
+		Actor->ForceNetUpdate();
+	}
+
+	MergeLivePlayers(*CheckpointWorld);
+
+	return bSuccess;
+}
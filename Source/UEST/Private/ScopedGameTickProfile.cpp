@@ -0,0 +1,284 @@
+#include "ScopedGameTickProfile.h"
+#include "Engine/GameInstance.h"
+
+static const TCHAR* GetPhaseName(const EScopedGameTickPhase Phase)
+{
+	switch (Phase)
+	{
+		case EScopedGameTickPhase::EngineTick: return TEXT("EngineTick");
+		case EScopedGameTickPhase::WorldTravel: return TEXT("WorldTravel");
+		case EScopedGameTickPhase::LevelStreaming: return TEXT("LevelStreaming");
+		case EScopedGameTickPhase::WorldTick: return TEXT("WorldTick");
+		default: return TEXT("Unknown");
+	}
+}
+
+double FScopedGameTickStats::GetAverageSeconds() const
+{
+	if (FrameSeconds.IsEmpty())
+	{
+		return 0;
+	}
+
+	double Result = 0;
+	for (const auto Seconds : FrameSeconds)
+	{
+		Result += Seconds;
+	}
+
+	return Result / FrameSeconds.Num();
+}
+
+double FScopedGameTickStats::GetMaxSeconds() const
+{
+	return FrameSeconds.IsEmpty() ? 0 : FMath::Max(FrameSeconds);
+}
+
+double FScopedGameTickStats::GetPercentileSeconds(const double Percentile) const
+{
+	if (FrameSeconds.IsEmpty())
+	{
+		return 0;
+	}
+
+	auto Sorted = FrameSeconds;
+	Sorted.Sort();
+
+	const auto Index = FMath::Clamp(FMath::CeilToInt(Percentile * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+	return Sorted[Index];
+}
+
+int32 FScopedGameTickProfile::AddGame(const UGameInstance& Game)
+{
+	const auto* WorldContext = Game.GetWorldContext();
+	const auto GameIndex = GameNames.Add(FString::Printf(TEXT("%s #%d (PIE %d)"), *Game.GetClass()->GetName(), GameNames.Num(), WorldContext ? WorldContext->PIEInstance : INDEX_NONE));
+	GameIndices.Emplace(&Game, GameIndex);
+	return GameIndex;
+}
+
+void FScopedGameTickProfile::RemoveGame(const UGameInstance& Game)
+{
+	GameIndices.Remove(&Game);
+}
+
+int32 FScopedGameTickProfile::FindGameIndex(const UGameInstance& Game) const
+{
+	const auto* GameIndex = GameIndices.Find(&Game);
+	return GameIndex ? *GameIndex : INDEX_NONE;
+}
+
+FScopedGameFrameProfile& FScopedGameTickProfile::AddFrame()
+{
+	auto& Frame = Frames.AddDefaulted_GetRef();
+	Frame.GamePhaseSeconds.Init(FScopedGameFrameProfile::FPhaseSeconds(InPlace, 0.0), GameNames.Num());
+	Frame.GameTickGroupSeconds.Init(FScopedGameFrameProfile::FTickGroupSeconds(InPlace, 0.0), GameNames.Num());
+	Frame.TickedGames.Init(false, GameNames.Num());
+	return Frame;
+}
+
+static double GetFrameGameSeconds(const FScopedGameFrameProfile& Frame, const int32 GameIndex)
+{
+	double Result = 0;
+	if (Frame.GamePhaseSeconds.IsValidIndex(GameIndex))
+	{
+		for (const auto Seconds : Frame.GamePhaseSeconds[GameIndex])
+		{
+			Result += Seconds;
+		}
+	}
+
+	return Result;
+}
+
+double FScopedGameTickProfile::GetPhaseSeconds(const EScopedGameTickPhase Phase) const
+{
+	double Result = 0;
+
+	for (const auto& Frame : Frames)
+	{
+		if (Phase == EScopedGameTickPhase::EngineTick)
+		{
+			Result += Frame.EngineTickSeconds;
+			continue;
+		}
+
+		for (const auto& PhaseSeconds : Frame.GamePhaseSeconds)
+		{
+			Result += PhaseSeconds[static_cast<int32>(Phase)];
+		}
+	}
+
+	return Result;
+}
+
+double FScopedGameTickProfile::GetTickGroupSeconds(const ETickingGroup TickGroup) const
+{
+	double Result = 0;
+
+	if (!ensure(TickGroup < FScopedGameFrameProfile::NumTickGroups))
+	{
+		return Result;
+	}
+
+	for (const auto& Frame : Frames)
+	{
+		for (const auto& TickGroupSeconds : Frame.GameTickGroupSeconds)
+		{
+			Result += TickGroupSeconds[TickGroup];
+		}
+	}
+
+	return Result;
+}
+
+double FScopedGameTickProfile::GetGameTickGroupSeconds(const UGameInstance& Game, const ETickingGroup TickGroup) const
+{
+	double Result = 0;
+
+	const auto GameIndex = FindGameIndex(Game);
+	if (!ensure(TickGroup < FScopedGameFrameProfile::NumTickGroups))
+	{
+		return Result;
+	}
+
+	for (const auto& Frame : Frames)
+	{
+		if (Frame.GameTickGroupSeconds.IsValidIndex(GameIndex))
+		{
+			Result += Frame.GameTickGroupSeconds[GameIndex][TickGroup];
+		}
+	}
+
+	return Result;
+}
+
+double FScopedGameTickProfile::GetGameSeconds(const UGameInstance& Game) const
+{
+	return GetGameSeconds(FindGameIndex(Game));
+}
+
+double FScopedGameTickProfile::GetGameSeconds(const FString& GameName) const
+{
+	return GetGameSeconds(GameNames.Find(GameName));
+}
+
+double FScopedGameTickProfile::GetGameSeconds(const int32 GameIndex) const
+{
+	double Result = 0;
+
+	for (const auto& Frame : Frames)
+	{
+		Result += GetFrameGameSeconds(Frame, GameIndex);
+	}
+
+	return Result;
+}
+
+FScopedGameTickStats FScopedGameTickProfile::GetGameStats(const UGameInstance& Game) const
+{
+	FScopedGameTickStats Result;
+
+	const auto GameIndex = FindGameIndex(Game);
+	if (!GameNames.IsValidIndex(GameIndex))
+	{
+		return Result;
+	}
+
+	Result.GameName = GameNames[GameIndex];
+
+	for (const auto& Frame : Frames)
+	{
+		if (Frame.TickedGames.IsValidIndex(GameIndex) && Frame.TickedGames[GameIndex])
+		{
+			Result.FrameSeconds.Add(GetFrameGameSeconds(Frame, GameIndex));
+		}
+	}
+
+	return Result;
+}
+
+double FScopedGameTickProfile::GetTotalSeconds() const
+{
+	double Result = 0;
+
+	for (const auto& Frame : Frames)
+	{
+		Result += Frame.TotalSeconds;
+	}
+
+	return Result;
+}
+
+TArray<TPair<FString, double>> FScopedGameTickProfile::GetSlowestGames(const int32 Count) const
+{
+	TArray<TPair<FString, double>> Result;
+	Result.Reserve(GameNames.Num());
+	for (int32 GameIndex = 0; GameIndex < GameNames.Num(); ++GameIndex)
+	{
+		Result.Emplace(GameNames[GameIndex], GetGameSeconds(GameIndex));
+	}
+
+	Result.Sort([](const auto& A, const auto& B) { return A.Value > B.Value; });
+	Result.SetNum(FMath::Min(Result.Num(), Count));
+	return Result;
+}
+
+TArray<const FScopedGameFrameProfile*> FScopedGameTickProfile::GetSlowestFrames(const int32 Count) const
+{
+	TArray<const FScopedGameFrameProfile*> Result;
+	Result.Reserve(Frames.Num());
+	for (const auto& Frame : Frames)
+	{
+		Result.Add(&Frame);
+	}
+
+	Result.Sort([](const FScopedGameFrameProfile& A, const FScopedGameFrameProfile& B) { return A.TotalSeconds > B.TotalSeconds; });
+	Result.SetNum(FMath::Min(Result.Num(), Count));
+	return Result;
+}
+
+FString FScopedGameTickProfile::GetSummary(const int32 TopCount) const
+{
+	TStringBuilder<1024> Result;
+	Result.Appendf(TEXT("Ticked %d frames in %.3f ms"), Frames.Num(), GetTotalSeconds() * 1000);
+
+	TArray<TPair<EScopedGameTickPhase, double>> Phases;
+	for (int32 Phase = 0; Phase < static_cast<int32>(EScopedGameTickPhase::Num); ++Phase)
+	{
+		Phases.Emplace(static_cast<EScopedGameTickPhase>(Phase), GetPhaseSeconds(static_cast<EScopedGameTickPhase>(Phase)));
+	}
+	Phases.Sort([](const auto& A, const auto& B) { return A.Value > B.Value; });
+
+	Result.Append(TEXT("\nPhases:"));
+	for (const auto& [Phase, Seconds] : Phases)
+	{
+		Result.Appendf(TEXT("\n  %s: %.3f ms"), GetPhaseName(Phase), Seconds * 1000);
+	}
+
+	TArray<TPair<ETickingGroup, double>> TickGroups;
+	for (int32 TickGroup = 0; TickGroup < FScopedGameFrameProfile::NumTickGroups; ++TickGroup)
+	{
+		TickGroups.Emplace(static_cast<ETickingGroup>(TickGroup), GetTickGroupSeconds(static_cast<ETickingGroup>(TickGroup)));
+	}
+	TickGroups.Sort([](const auto& A, const auto& B) { return A.Value > B.Value; });
+
+	Result.Append(TEXT("\nTick groups:"));
+	for (const auto& [TickGroup, Seconds] : TickGroups)
+	{
+		Result.Appendf(TEXT("\n  %s: %.3f ms"), *UEnum::GetValueAsString(TickGroup), Seconds * 1000);
+	}
+
+	Result.Append(TEXT("\nSlowest games:"));
+	for (const auto& [GameName, Seconds] : GetSlowestGames(TopCount))
+	{
+		Result.Appendf(TEXT("\n  %s: %.3f ms"), *GameName, Seconds * 1000);
+	}
+
+	Result.Append(TEXT("\nSlowest frames:"));
+	for (const auto* Frame : GetSlowestFrames(TopCount))
+	{
+		Result.Appendf(TEXT("\n  #%llu: %.3f ms"), Frame->FrameCounter, Frame->TotalSeconds * 1000);
+	}
+
+	return Result.ToString();
+}
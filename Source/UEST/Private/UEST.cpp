@@ -1,9 +1,52 @@
 #include "UEST.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
 #include "Modules/ModuleManager.h"
+#include "UESTTestManifest.h"
+
+static TArray<FUESTTestBase*>& GetMutableRegisteredTests()
+{
+	static TArray<FUESTTestBase*> RegisteredTests;
+	return RegisteredTests;
+}
 
 FUESTTestBase::FUESTTestBase(const FString& InName, bool bIsComplex)
     : FAutomationTestBase(InName, bIsComplex)
 {
+	GetMutableRegisteredTests().Add(this);
+}
+
+FUESTTestBase::~FUESTTestBase()
+{
+	GetMutableRegisteredTests().RemoveSingleSwap(this);
+}
+
+const TArray<FUESTTestBase*>& FUESTTestBase::GetRegisteredTests()
+{
+	return GetMutableRegisteredTests();
+}
+
+TArray<FString> FUESTTestBase::GetTestMethodNames() const
+{
+	TArray<FString> Result;
+	for (const auto* Method = FirstMethod; Method; Method = Method->Next)
+	{
+		Result.Emplace(Method->Name);
+	}
+	return Result;
+}
+
+const FUESTTestBase::FTestMethodInfo* FUESTTestBase::FindTestMethod(const FString& InTestName) const
+{
+	for (const auto* Method = FirstMethod; Method; Method = Method->Next)
+	{
+		if (InTestName == Method->Name)
+		{
+			return &Method->Info;
+		}
+	}
+
+	return nullptr;
 }
 
 uint32 FUESTTestBase::GetRequiredDeviceNum() const
@@ -13,10 +56,10 @@ uint32 FUESTTestBase::GetRequiredDeviceNum() const
 
 void FUESTTestBase::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
 {
-	if (TestMethods.Num())
+	if (FirstMethod)
 	{
-		TestMethods.GenerateKeyArray(OutBeautifiedNames);
-		TestMethods.GenerateKeyArray(OutTestCommands);
+		OutBeautifiedNames = GetTestMethodNames();
+		OutTestCommands = OutBeautifiedNames;
 	}
 	else
 	{
@@ -40,10 +83,9 @@ static FString ExtractTestMethod(const FString& InTestName)
 
 FString FUESTTestBase::GetTestSourceFileName(const FString& InTestName) const
 {
-	if (TestMethods.Num())
+	if (FirstMethod)
 	{
-		const auto& TestMethod = ExtractTestMethod(InTestName);
-		if (const auto* TestInfo = TestMethods.Find(TestMethod); ensure(TestInfo))
+		if (const auto* TestInfo = FindTestMethod(ExtractTestMethod(InTestName)); ensure(TestInfo))
 		{
 			return TestInfo->FileName;
 		}
@@ -54,10 +96,9 @@ FString FUESTTestBase::GetTestSourceFileName(const FString& InTestName) const
 
 int32 FUESTTestBase::GetTestSourceFileLine(const FString& InTestName) const
 {
-	if (TestMethods.Num())
+	if (FirstMethod)
 	{
-		const auto& TestMethod = ExtractTestMethod(InTestName);
-		if (const auto* TestInfo = TestMethods.Find(TestMethod); ensure(TestInfo))
+		if (const auto* TestInfo = FindTestMethod(ExtractTestMethod(InTestName)); ensure(TestInfo))
 		{
 			return TestInfo->FileLine;
 		}
@@ -68,9 +109,9 @@ int32 FUESTTestBase::GetTestSourceFileLine(const FString& InTestName) const
 
 bool FUESTTestBase::RunTest(const FString& InTestName)
 {
-	if (TestMethods.Num())
+	if (FirstMethod)
 	{
-		if (const auto* TestInfo = TestMethods.Find(InTestName); ensure(TestInfo))
+		if (const auto* TestInfo = FindTestMethod(InTestName); ensure(TestInfo))
 		{
 			Setup();
 
@@ -88,4 +129,46 @@ bool FUESTTestBase::RunTest(const FString& InTestName)
 	return true;
 }
 
-IMPLEMENT_MODULE(FDefaultModuleImpl, UEST)
+static TAutoConsoleVariable<bool> CVarCaptureAssertionStack{
+    TEXT("UEST.CaptureAssertionStack"),
+    false,
+    TEXT("Report failed assertions through ensure, which captures call stack and breaks into attached debugger"),
+};
+
+void UEST::ReportAssertionFailure(const FStringView Message, const TCHAR* FileName, const int32 FileLine)
+{
+	auto* CurrentTest = FAutomationTestFramework::Get().GetCurrentTest();
+	if (CurrentTest == nullptr || CVarCaptureAssertionStack.GetValueOnAnyThread())
+	{
+		ensureAlwaysMsgf(false, TEXT("%.*s [%s(%d)]"), Message.Len(), Message.GetData(), FileName, FileLine);
+		return;
+	}
+
+	// Location is known at compile time, so there is no need to resolve it from stack. Automation only fills entry Filename and LineNumber
+	// from a captured stack, so location goes to the message in File(Line) form, which logs and IDEs link to.
+	CurrentTest->AddEvent(FAutomationEvent{EAutomationEventType::Error, FString::Printf(TEXT("%.*s [%s(%d)]"), Message.Len(), Message.GetData(), FileName, FileLine)}, 0, false);
+}
+
+class FUESTModule final : public IModuleInterface
+{
+	FDelegateHandle PostEngineInitHandle;
+
+public:
+	virtual void StartupModule() override
+	{
+		// Modules with tests are loaded by then, so manifest is complete. Processes that cannot run tests have nothing to list.
+		PostEngineInitHandle = FCoreDelegates::OnPostEngineInit.AddLambda([] {
+			if (FModuleManager::Get().IsModuleLoaded(TEXT("AutomationWorker")) || FModuleManager::Get().IsModuleLoaded(TEXT("AutomationController")))
+			{
+				FUESTTestManifest::Write();
+			}
+		});
+	}
+
+	virtual void ShutdownModule() override
+	{
+		FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+	}
+};
+
+IMPLEMENT_MODULE(FUESTModule, UEST)
@@ -0,0 +1,612 @@
+#include "UESTBenchmark.h"
+#include "Dom/JsonObject.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformTLS.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/EngineVersionComparison.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogUESTBenchmark, Log, All);
+
+static TAutoConsoleVariable<float> CVarWarmupSeconds{
+    TEXT("UEST.Benchmark.WarmupSeconds"),
+    0.1f,
+    TEXT("How long benchmarks run before measuring, also used to estimate iteration count"),
+};
+
+static TAutoConsoleVariable<float> CVarTargetSeconds{
+    TEXT("UEST.Benchmark.TargetSeconds"),
+    1.f,
+    TEXT("How long all samples of a benchmark should take together"),
+};
+
+static TAutoConsoleVariable<int32> CVarSamples{
+    TEXT("UEST.Benchmark.Samples"),
+    30,
+    TEXT("Number of samples statistics are computed from"),
+};
+
+static TAutoConsoleVariable<float> CVarRegressionThreshold{
+    TEXT("UEST.Benchmark.RegressionThreshold"),
+    0.1f,
+    TEXT("Fraction by which median time or allocations may exceed baseline before benchmark fails, e.g. 0.1 for 10%"),
+};
+
+static TAutoConsoleVariable<bool> CVarCountAllocations{
+    TEXT("UEST.Benchmark.CountAllocations"),
+    false,
+    TEXT("Count allocations made by benchmarks, adds a little overhead to every allocation"),
+};
+
+static TAutoConsoleVariable<FString> CVarResultsDir{
+    TEXT("UEST.Benchmark.ResultsDir"),
+    TEXT(""),
+    TEXT("Directory for benchmark results, <ProjectSavedDir>/UEST/Benchmarks/Results when empty"),
+};
+
+static TAutoConsoleVariable<FString> CVarBaselineDir{
+    TEXT("UEST.Benchmark.BaselineDir"),
+    TEXT(""),
+    TEXT("Directory for benchmark baselines, <ProjectSavedDir>/UEST/Benchmarks/Baseline when empty"),
+};
+
+static TAutoConsoleVariable<bool> CVarUpdateBaseline{
+    TEXT("UEST.Benchmark.UpdateBaseline"),
+    false,
+    TEXT("Write benchmark results as new baseline instead of comparing with it"),
+};
+
+/**
+ * Counts allocations of a single thread and forwards everything to the allocator it replaced.
+ * Memory is never owned by the proxy, so it can be installed while allocations already exist.
+ */
+class FUESTCountingMalloc final : public FMalloc
+{
+public:
+	explicit FUESTCountingMalloc(FMalloc* Inner)
+	    : Inner{Inner}
+	{
+	}
+
+	FMalloc* const Inner;
+
+	/** Thread whose allocations are counted, 0 when nothing is counted */
+	std::atomic<uint32> ThreadId = 0;
+
+	int64 Allocations = 0;
+
+	int64 AllocatedBytes = 0;
+
+	virtual void* Malloc(const SIZE_T Count, const uint32 Alignment) override
+	{
+		CountAllocation(Count);
+		return Inner->Malloc(Count, Alignment);
+	}
+
+	virtual void* TryMalloc(const SIZE_T Count, const uint32 Alignment) override
+	{
+		CountAllocation(Count);
+		return Inner->TryMalloc(Count, Alignment);
+	}
+
+#if !UE_VERSION_OLDER_THAN(5, 3, 0)
+	virtual void* MallocZeroed(const SIZE_T Count, const uint32 Alignment) override
+	{
+		CountAllocation(Count);
+		return Inner->MallocZeroed(Count, Alignment);
+	}
+
+	virtual void* TryMallocZeroed(const SIZE_T Count, const uint32 Alignment) override
+	{
+		CountAllocation(Count);
+		return Inner->TryMallocZeroed(Count, Alignment);
+	}
+#endif
+
+	virtual void* Realloc(void* Original, const SIZE_T Count, const uint32 Alignment) override
+	{
+		auto* Result = Inner->Realloc(Original, Count, Alignment);
+
+		// Resizing in place does not allocate
+		if (Result != Original)
+		{
+			CountAllocation(Count);
+		}
+
+		return Result;
+	}
+
+	virtual void* TryRealloc(void* Original, const SIZE_T Count, const uint32 Alignment) override
+	{
+		auto* Result = Inner->TryRealloc(Original, Count, Alignment);
+
+		// Resizing in place does not allocate
+		if (Result != Original)
+		{
+			CountAllocation(Count);
+		}
+
+		return Result;
+	}
+
+	virtual void Free(void* Original) override
+	{
+		Inner->Free(Original);
+	}
+
+	virtual SIZE_T QuantizeSize(const SIZE_T Count, const uint32 Alignment) override
+	{
+		return Inner->QuantizeSize(Count, Alignment);
+	}
+
+	virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+	{
+		return Inner->GetAllocationSize(Original, SizeOut);
+	}
+
+	virtual void Trim(const bool bTrimThreadCaches) override
+	{
+		Inner->Trim(bTrimThreadCaches);
+	}
+
+	virtual uint64 GetImmediatelyFreeableCachedMemory() override
+	{
+		return Inner->GetImmediatelyFreeableCachedMemory();
+	}
+
+	virtual void SetupTLSCachesOnCurrentThread() override
+	{
+		Inner->SetupTLSCachesOnCurrentThread();
+	}
+
+	virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+	{
+		Inner->ClearAndDisableTLSCachesOnCurrentThread();
+	}
+
+	virtual void MarkTLSCachesAsUsedOnCurrentThread() override
+	{
+		Inner->MarkTLSCachesAsUsedOnCurrentThread();
+	}
+
+	virtual void MarkTLSCachesAsUnusedOnCurrentThread() override
+	{
+		Inner->MarkTLSCachesAsUnusedOnCurrentThread();
+	}
+
+	virtual bool IsInternallyThreadSafe() const override
+	{
+		return Inner->IsInternallyThreadSafe();
+	}
+
+	virtual bool ValidateHeap() override
+	{
+		return Inner->ValidateHeap();
+	}
+
+	virtual void InitializeStatsMetadata() override
+	{
+		Inner->InitializeStatsMetadata();
+	}
+
+	virtual void UpdateStats() override
+	{
+		Inner->UpdateStats();
+	}
+
+	virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override
+	{
+		Inner->GetAllocatorStats(OutStats);
+	}
+
+	virtual void DumpAllocatorStats(FOutputDevice& Ar) override
+	{
+		Inner->DumpAllocatorStats(Ar);
+	}
+
+	virtual const TCHAR* GetDescriptiveName() override
+	{
+		return Inner->GetDescriptiveName();
+	}
+
+	virtual void OnMallocInitialized() override
+	{
+		Inner->OnMallocInitialized();
+	}
+
+	virtual void OnPreFork() override
+	{
+		Inner->OnPreFork();
+	}
+
+	virtual void OnPostFork() override
+	{
+		Inner->OnPostFork();
+	}
+
+	virtual bool Exec(UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar) override
+	{
+		return Inner->Exec(InWorld, Cmd, Ar);
+	}
+
+private:
+	void CountAllocation(const SIZE_T Size)
+	{
+		// Only benchmark thread writes counters, so they need no synchronization
+		if (Size > 0 && ThreadId.load(std::memory_order_relaxed) == FPlatformTLS::GetCurrentThreadId())
+		{
+			++Allocations;
+			AllocatedBytes += Size;
+		}
+	}
+};
+
+/**
+ * Installed as GMalloc when first benchmark counts allocations and never removed, as any thread may be inside it at any time.
+ * Benchmarks only toggle its ThreadId, otherwise it just forwards to allocator it replaced.
+ */
+static FUESTCountingMalloc& GetCountingMalloc()
+{
+	// Initialization of function-local static is synchronized, so concurrent benchmarks install exactly one proxy
+	static auto& CountingMalloc = []() -> FUESTCountingMalloc& {
+		auto* Proxy = new FUESTCountingMalloc{GMalloc};
+
+		// Proxy must be fully constructed before other threads can see it through GMalloc
+		FPlatformMisc::MemoryBarrier();
+		GMalloc = Proxy;
+		return *Proxy;
+	}();
+
+	return CountingMalloc;
+}
+
+static FString GetBenchmarkPath(const TAutoConsoleVariable<FString>& Directory, const TCHAR* DefaultDirectory, const FString& Name)
+{
+	auto Path = Directory.GetValueOnAnyThread();
+	if (Path.IsEmpty())
+	{
+		Path = FPaths::ProjectSavedDir() / TEXT("UEST") / TEXT("Benchmarks") / DefaultDirectory;
+	}
+
+	return Path / FPaths::MakeValidFileName(Name) + TEXT(".json");
+}
+
+FString FUESTBenchmarkResult::GetResultPath(const FString& Name)
+{
+	return GetBenchmarkPath(CVarResultsDir, TEXT("Results"), Name);
+}
+
+FString FUESTBenchmarkResult::GetBaselinePath(const FString& Name)
+{
+	return GetBenchmarkPath(CVarBaselineDir, TEXT("Baseline"), Name);
+}
+
+FUESTBenchmarkResult FUESTBenchmarkResult::FromSamples(const FString& Name, TArray<double> SampleSeconds, const int64 IterationsPerSample)
+{
+	FUESTBenchmarkResult Result;
+	Result.Name = Name;
+	Result.IterationsPerSample = IterationsPerSample;
+	Result.NumSamples = SampleSeconds.Num();
+	if (SampleSeconds.IsEmpty())
+	{
+		return Result;
+	}
+
+	SampleSeconds.Sort();
+
+	const auto Num = SampleSeconds.Num();
+	Result.MinSeconds = SampleSeconds[0];
+	Result.MedianSeconds = Num % 2 == 1 ? SampleSeconds[Num / 2] : (SampleSeconds[Num / 2 - 1] + SampleSeconds[Num / 2]) / 2;
+	Result.P95Seconds = SampleSeconds[FMath::Clamp(FMath::CeilToInt32(Num * 0.95) - 1, 0, Num - 1)];
+
+	auto Sum = 0.0;
+	for (const auto Seconds : SampleSeconds)
+	{
+		Sum += Seconds;
+	}
+	Result.MeanSeconds = Sum / Num;
+
+	if (Num > 1)
+	{
+		auto SquaredDeviations = 0.0;
+		for (const auto Seconds : SampleSeconds)
+		{
+			SquaredDeviations += FMath::Square(Seconds - Result.MeanSeconds);
+		}
+		Result.StdDevSeconds = FMath::Sqrt(SquaredDeviations / (Num - 1));
+	}
+
+	return Result;
+}
+
+FString FUESTBenchmarkResult::ToJson() const
+{
+	const auto Object = MakeShared<FJsonObject>();
+	Object->SetNumberField(TEXT("Version"), Version);
+	Object->SetStringField(TEXT("Name"), Name);
+	Object->SetNumberField(TEXT("IterationsPerSample"), IterationsPerSample);
+	Object->SetNumberField(TEXT("Samples"), NumSamples);
+	Object->SetNumberField(TEXT("MinSeconds"), MinSeconds);
+	Object->SetNumberField(TEXT("MedianSeconds"), MedianSeconds);
+	Object->SetNumberField(TEXT("P95Seconds"), P95Seconds);
+	Object->SetNumberField(TEXT("MeanSeconds"), MeanSeconds);
+	Object->SetNumberField(TEXT("StdDevSeconds"), StdDevSeconds);
+	if (HasAllocations())
+	{
+		Object->SetNumberField(TEXT("AllocationsPerIteration"), AllocationsPerIteration);
+		Object->SetNumberField(TEXT("AllocatedBytesPerIteration"), AllocatedBytesPerIteration);
+	}
+
+	FString Result;
+	const auto Writer = TJsonWriterFactory<>::Create(&Result);
+	FJsonSerializer::Serialize(Object, Writer);
+	return Result;
+}
+
+TOptional<FUESTBenchmarkResult> FUESTBenchmarkResult::FromJson(const FString& Json)
+{
+	TSharedPtr<FJsonObject> Object;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Object) || !Object.IsValid())
+	{
+		return {};
+	}
+
+	if (int32 FileVersion; !Object->TryGetNumberField(TEXT("Version"), FileVersion) || FileVersion != Version)
+	{
+		return {};
+	}
+
+	FUESTBenchmarkResult Result;
+	if (!Object->TryGetStringField(TEXT("Name"), Result.Name) || !Object->TryGetNumberField(TEXT("MedianSeconds"), Result.MedianSeconds))
+	{
+		return {};
+	}
+
+	Object->TryGetNumberField(TEXT("IterationsPerSample"), Result.IterationsPerSample);
+	Object->TryGetNumberField(TEXT("Samples"), Result.NumSamples);
+	Object->TryGetNumberField(TEXT("MinSeconds"), Result.MinSeconds);
+	Object->TryGetNumberField(TEXT("P95Seconds"), Result.P95Seconds);
+	Object->TryGetNumberField(TEXT("MeanSeconds"), Result.MeanSeconds);
+	Object->TryGetNumberField(TEXT("StdDevSeconds"), Result.StdDevSeconds);
+	Object->TryGetNumberField(TEXT("AllocationsPerIteration"), Result.AllocationsPerIteration);
+	Object->TryGetNumberField(TEXT("AllocatedBytesPerIteration"), Result.AllocatedBytesPerIteration);
+	return Result;
+}
+
+static FString FormatSeconds(const double Seconds)
+{
+	if (Seconds < 1e-6)
+	{
+		return FString::Printf(TEXT("%.1f ns"), Seconds * 1e9);
+	}
+
+	if (Seconds < 1e-3)
+	{
+		return FString::Printf(TEXT("%.1f us"), Seconds * 1e6);
+	}
+
+	if (Seconds < 1)
+	{
+		return FString::Printf(TEXT("%.1f ms"), Seconds * 1e3);
+	}
+
+	return FString::Printf(TEXT("%.2f s"), Seconds);
+}
+
+FString FUESTBenchmarkResult::GetSummary() const
+{
+	auto Summary = FString::Printf(TEXT("median %s, min %s, p95 %s, stddev %s over %d samples of %lld iterations"),
+	    *FormatSeconds(MedianSeconds), *FormatSeconds(MinSeconds), *FormatSeconds(P95Seconds), *FormatSeconds(StdDevSeconds), NumSamples, IterationsPerSample);
+	if (HasAllocations())
+	{
+		Summary += FString::Printf(TEXT(", %.1f allocations (%.0f bytes) per iteration"), AllocationsPerIteration, AllocatedBytesPerIteration);
+	}
+
+	return Summary;
+}
+
+FUESTBenchmark::FUESTBenchmark()
+    : WarmupSeconds{CVarWarmupSeconds.GetValueOnAnyThread()}
+    , TargetSeconds{CVarTargetSeconds.GetValueOnAnyThread()}
+    , NumSamples{FMath::Max(1, CVarSamples.GetValueOnAnyThread())}
+    , RegressionThreshold{CVarRegressionThreshold.GetValueOnAnyThread()}
+    , bCountAllocations{CVarCountAllocations.GetValueOnAnyThread()}
+{
+	// Adding a sample must not allocate while allocations are counted
+	Samples.Reserve(NumSamples);
+}
+
+FUESTBenchmark::~FUESTBenchmark()
+{
+	StopCountingAllocations();
+}
+
+void FUESTBenchmark::SetRegressionThreshold(const double Threshold)
+{
+	RegressionThreshold = Threshold;
+}
+
+void FUESTBenchmark::SetCountAllocations(const bool bCount)
+{
+	ensureMsgf(Phase == EPhase::NotStarted, TEXT("Benchmark settings must be changed before its loop"));
+	bCountAllocations = bCount;
+}
+
+void FUESTBenchmark::SetSampleCount(const int32 Count)
+{
+	ensureMsgf(Phase == EPhase::NotStarted, TEXT("Benchmark settings must be changed before its loop"));
+	NumSamples = FMath::Max(1, Count);
+	Samples.Reserve(NumSamples);
+}
+
+bool FUESTBenchmark::NextBatch()
+{
+	const auto Seconds = (FPlatformTime::Cycles64() - BatchStartCycles) * FPlatformTime::GetSecondsPerCycle64();
+
+	switch (Phase)
+	{
+	case EPhase::NotStarted:
+		Phase = EPhase::Warmup;
+		StartBatch(1);
+		return true;
+
+	case EPhase::Warmup:
+	{
+		ElapsedWarmupSeconds += Seconds;
+		if (ElapsedWarmupSeconds < WarmupSeconds)
+		{
+			StartBatch(BatchSize * 2);
+			return true;
+		}
+
+		// Last warmup batch is the largest, so it gives the best estimate
+		const auto SecondsPerSample = TargetSeconds / NumSamples;
+		const auto SecondsPerIteration = FMath::Max(Seconds / BatchSize, UE_DOUBLE_SMALL_NUMBER);
+		const auto IterationsPerSample = FMath::Clamp<double>(FMath::CeilToDouble(SecondsPerSample / SecondsPerIteration), 1, MAX_int32);
+
+		Phase = EPhase::Sampling;
+		if (bCountAllocations)
+		{
+			auto& CountingMalloc = GetCountingMalloc();
+			if (uint32 CountingThreadId = 0; CountingMalloc.ThreadId.compare_exchange_strong(CountingThreadId, FPlatformTLS::GetCurrentThreadId()))
+			{
+				// Counters are only written by counting thread, which is this one from now on
+				CountingMalloc.Allocations = 0;
+				CountingMalloc.AllocatedBytes = 0;
+			}
+			else
+			{
+				UE_LOG(LogUESTBenchmark, Warning, TEXT("Allocations are not counted, benchmark on another thread already counts them"));
+				bCountAllocations = false;
+			}
+		}
+
+		StartBatch(static_cast<int64>(IterationsPerSample));
+		return true;
+	}
+
+	case EPhase::Sampling:
+		Samples.Add(Seconds / BatchSize);
+		if (Samples.Num() < NumSamples)
+		{
+			StartBatch(BatchSize);
+			return true;
+		}
+
+		StopCountingAllocations();
+		Phase = EPhase::Done;
+		return false;
+
+	case EPhase::Done:
+	default:
+		return false;
+	}
+}
+
+void FUESTBenchmark::StartBatch(const int64 Size)
+{
+	BatchSize = Size;
+
+	// This call already returns true for the first iteration of the batch
+	RemainingInBatch = Size - 1;
+
+	BatchStartCycles = FPlatformTime::Cycles64();
+}
+
+void FUESTBenchmark::StopCountingAllocations()
+{
+	if (!bCountAllocations || Phase == EPhase::NotStarted || Phase == EPhase::Warmup)
+	{
+		return;
+	}
+
+	auto& CountingMalloc = GetCountingMalloc();
+	if (CountingMalloc.ThreadId.load() != FPlatformTLS::GetCurrentThreadId())
+	{
+		return;
+	}
+
+	Allocations = CountingMalloc.Allocations;
+	AllocatedBytes = CountingMalloc.AllocatedBytes;
+	CountingMalloc.ThreadId = 0;
+}
+
+void FUESTBenchmark::Escape(const volatile void* Pointer)
+{
+	// Out of line, so compiler has to assume that Pointer is read
+}
+
+void FUESTBenchmark::Run(FAutomationTestBase& Test, const FString& Name, const TFunctionRef<void(FUESTBenchmark&)> Body)
+{
+	FUESTBenchmark Benchmark;
+	Body(Benchmark);
+	Benchmark.StopCountingAllocations();
+
+	if (Benchmark.Phase != EPhase::Done)
+	{
+		// Failed assertion inside of the loop already explains what went wrong
+		if (!Test.HasAnyErrors())
+		{
+			Test.AddError(FString::Printf(TEXT("Benchmark %s must run its loop to the end"), *Name));
+		}
+		return;
+	}
+
+	auto Result = FUESTBenchmarkResult::FromSamples(Name, MoveTemp(Benchmark.Samples), Benchmark.BatchSize);
+	if (Benchmark.bCountAllocations)
+	{
+		const auto Iterations = static_cast<double>(Result.IterationsPerSample) * Result.NumSamples;
+		Result.AllocationsPerIteration = Benchmark.Allocations / Iterations;
+		Result.AllocatedBytesPerIteration = Benchmark.AllocatedBytes / Iterations;
+	}
+
+	Test.AddInfo(FString::Printf(TEXT("%s: %s"), *Name, *ToString(Result)));
+
+	const auto bUpdateBaseline = CVarUpdateBaseline.GetValueOnAnyThread();
+	const auto Path = bUpdateBaseline ? FUESTBenchmarkResult::GetBaselinePath(Name) : FUESTBenchmarkResult::GetResultPath(Name);
+	if (!FFileHelper::SaveStringToFile(Result.ToJson(), *Path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+	{
+		UE_LOG(LogUESTBenchmark, Warning, TEXT("Failed to write benchmark result to %s"), *Path);
+	}
+
+	if (bUpdateBaseline)
+	{
+		return;
+	}
+
+	const auto BaselinePath = FUESTBenchmarkResult::GetBaselinePath(Name);
+	TOptional<FUESTBenchmarkResult> Baseline;
+	if (FString Json; FFileHelper::LoadFileToString(Json, *BaselinePath))
+	{
+		Baseline = FUESTBenchmarkResult::FromJson(Json);
+	}
+
+	if (!Baseline.IsSet())
+	{
+		Test.AddInfo(FString::Printf(TEXT("%s has no baseline at %s, run with UEST.Benchmark.UpdateBaseline=1 to record it"), *Name, *BaselinePath));
+		return;
+	}
+
+	// Median is the least sensitive to occasional slow samples caused by the rest of the machine
+	const auto Threshold = 1 + Benchmark.RegressionThreshold;
+	if (Result.MedianSeconds > Baseline->MedianSeconds * Threshold)
+	{
+		Test.AddError(FString::Printf(TEXT("%s regressed: median %s is %.1f%% slower than baseline %s, threshold is %.1f%%"),
+		    *Name,
+		    *FormatSeconds(Result.MedianSeconds),
+		    (Result.MedianSeconds / Baseline->MedianSeconds - 1) * 100,
+		    *FormatSeconds(Baseline->MedianSeconds),
+		    Benchmark.RegressionThreshold * 100));
+	}
+
+	if (Result.HasAllocations() && Baseline->HasAllocations() && Result.AllocationsPerIteration > Baseline->AllocationsPerIteration * Threshold)
+	{
+		Test.AddError(FString::Printf(TEXT("%s regressed: %.1f allocations per iteration, baseline is %.1f"),
+		    *Name,
+		    Result.AllocationsPerIteration,
+		    Baseline->AllocationsPerIteration));
+	}
+}
@@ -0,0 +1,163 @@
+#include "UESTBulkKernels.h"
+#include "Math/VectorRegister.h"
+
+namespace
+{
+	template<typename S>
+	struct TLanes;
+
+	template<>
+	struct TLanes<float>
+	{
+		using FRegister = VectorRegister4Float;
+
+		static FRegister Splat(const float Value)
+		{
+			return MakeVectorRegisterFloat(Value, Value, Value, Value);
+		}
+	};
+
+	template<>
+	struct TLanes<double>
+	{
+		using FRegister = VectorRegister4Double;
+
+		static FRegister Splat(const double Value)
+		{
+			return MakeVectorRegisterDouble(Value, Value, Value, Value);
+		}
+	};
+
+	constexpr int32 NumLanes = 4;
+
+	constexpr int32 AllLanesPassed = (1 << NumLanes) - 1;
+
+	/**
+	 * Runs vector check for every four components and scalar check for the remaining tail.
+	 * Vector check returns a bit mask with bits set for lanes that passed, as VectorMaskBits does.
+	 */
+	template<typename FVectorCheck, typename FScalarCheck>
+	void FindMismatches(const int32 Num, const int32 Stride, const FVectorCheck& VectorCheck, const FScalarCheck& ScalarCheck, UEST::Bulk::FMismatches& Out)
+	{
+		Out.Reset();
+
+		auto Index = 0;
+		for (; Index + NumLanes <= Num; Index += NumLanes)
+		{
+			if (const auto Passed = VectorCheck(Index); Passed != AllLanesPassed) [[unlikely]]
+			{
+				for (auto Lane = 0; Lane < NumLanes; ++Lane)
+				{
+					if ((Passed & (1 << Lane)) == 0)
+					{
+						Out.Add((Index + Lane) / Stride);
+					}
+				}
+			}
+		}
+
+		for (; Index < Num; ++Index)
+		{
+			if (!ScalarCheck(Index))
+			{
+				Out.Add(Index / Stride);
+			}
+		}
+	}
+
+	// Ordered comparisons are false for NaN, so every check is written as "passes when" to fail NaN without extra work
+
+	template<typename S>
+	void FindNotNearlyEqualImpl(const TConstArrayView<S> Values, const TConstArrayView<S> Expected, const S Tolerance, const int32 Stride, UEST::Bulk::FMismatches& Out)
+	{
+		if (!ensureAlwaysMsgf(Values.Num() == Expected.Num(), TEXT("Compared arrays have different sizes: %d and %d"), Values.Num(), Expected.Num()))
+		{
+			Out.Reset();
+			return;
+		}
+
+		const auto* ValuesData = Values.GetData();
+		const auto* ExpectedData = Expected.GetData();
+		const auto VectorTolerance = TLanes<S>::Splat(Tolerance);
+
+		FindMismatches(
+		    Values.Num(),
+		    Stride,
+		    [&](const int32 Index) {
+			    const auto Difference = VectorAbs(VectorSubtract(VectorLoad(ValuesData + Index), VectorLoad(ExpectedData + Index)));
+			    return VectorMaskBits(VectorCompareLE(Difference, VectorTolerance));
+		    },
+		    [&](const int32 Index) {
+			    return FMath::Abs(ValuesData[Index] - ExpectedData[Index]) <= Tolerance;
+		    },
+		    Out);
+	}
+
+	template<typename S>
+	void FindNotInRangeImpl(const TConstArrayView<S> Values, const S From, const S To, const int32 Stride, UEST::Bulk::FMismatches& Out)
+	{
+		const auto* ValuesData = Values.GetData();
+		const auto VectorFrom = TLanes<S>::Splat(From);
+		const auto VectorTo = TLanes<S>::Splat(To);
+
+		FindMismatches(
+		    Values.Num(),
+		    Stride,
+		    [&](const int32 Index) {
+			    const auto Value = VectorLoad(ValuesData + Index);
+			    return VectorMaskBits(VectorBitwiseAnd(VectorCompareGE(Value, VectorFrom), VectorCompareLE(Value, VectorTo)));
+		    },
+		    [&](const int32 Index) {
+			    return ValuesData[Index] >= From && ValuesData[Index] <= To;
+		    },
+		    Out);
+	}
+
+	template<typename S>
+	void FindNotFiniteImpl(const TConstArrayView<S> Values, const int32 Stride, UEST::Bulk::FMismatches& Out)
+	{
+		const auto* ValuesData = Values.GetData();
+		const auto VectorMax = TLanes<S>::Splat(TNumericLimits<S>::Max());
+
+		FindMismatches(
+		    Values.Num(),
+		    Stride,
+		    [&](const int32 Index) {
+			    return VectorMaskBits(VectorCompareLE(VectorAbs(VectorLoad(ValuesData + Index)), VectorMax));
+		    },
+		    [&](const int32 Index) {
+			    return FMath::IsFinite(ValuesData[Index]);
+		    },
+		    Out);
+	}
+} // namespace
+
+void UEST::Bulk::FindNotNearlyEqual(const TConstArrayView<float> Values, const TConstArrayView<float> Expected, const float Tolerance, const int32 Stride, FMismatches& Out)
+{
+	FindNotNearlyEqualImpl(Values, Expected, Tolerance, Stride, Out);
+}
+
+void UEST::Bulk::FindNotNearlyEqual(const TConstArrayView<double> Values, const TConstArrayView<double> Expected, const double Tolerance, const int32 Stride, FMismatches& Out)
+{
+	FindNotNearlyEqualImpl(Values, Expected, Tolerance, Stride, Out);
+}
+
+void UEST::Bulk::FindNotInRange(const TConstArrayView<float> Values, const float From, const float To, const int32 Stride, FMismatches& Out)
+{
+	FindNotInRangeImpl(Values, From, To, Stride, Out);
+}
+
+void UEST::Bulk::FindNotInRange(const TConstArrayView<double> Values, const double From, const double To, const int32 Stride, FMismatches& Out)
+{
+	FindNotInRangeImpl(Values, From, To, Stride, Out);
+}
+
+void UEST::Bulk::FindNotFinite(const TConstArrayView<float> Values, const int32 Stride, FMismatches& Out)
+{
+	FindNotFiniteImpl(Values, Stride, Out);
+}
+
+void UEST::Bulk::FindNotFinite(const TConstArrayView<double> Values, const int32 Stride, FMismatches& Out)
+{
+	FindNotFiniteImpl(Values, Stride, Out);
+}
@@ -0,0 +1,329 @@
+#include "UESTLoopbackNetDriver.h"
+#include "IPAddress.h"
+#include "PacketHandler.h"
+#include "PacketHandlers/StatelessConnectHandlerComponent.h"
+#include "SocketSubsystem.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogUESTLoopback, Log, All);
+
+/** Drivers that are currently able to receive packets, by address with port */
+static TMap<FString, TWeakObjectPtr<UUESTLoopbackNetDriver>> Endpoints;
+
+/** Next port that is given to client drivers, away from default game ports */
+static int32 NextClientPort = 50000;
+
+static float EmulatedLagSeconds = 0;
+
+static float EmulatedLossRatio = 0;
+
+static FRandomStream EmulatedLossRandom;
+
+/** Same value as used by UIpConnection, so bandwidth limits behave similarly */
+static constexpr int32 LoopbackMaxPacket = 1024;
+static constexpr int32 LoopbackPacketOverhead = 28;
+
+static TSharedRef<FInternetAddr> MakeLoopbackAddr(ISocketSubsystem& SocketSubsystem, const int32 Port)
+{
+	auto Result = SocketSubsystem.CreateInternetAddr();
+	Result->SetLoopbackAddress();
+	Result->SetPort(Port);
+	return Result;
+}
+
+bool UUESTLoopbackNetDriver::SendTo(const FInternetAddr& Address, const TSharedRef<const FInternetAddr>& From, const void* Data, const int32 CountBits)
+{
+	auto* Driver = Endpoints.FindRef(Address.ToString(true)).Get();
+	if (Driver == nullptr || CountBits <= 0)
+	{
+		return false;
+	}
+
+	// Lost packet is still sent as far as sender can tell
+	if (EmulatedLossRatio > 0 && EmulatedLossRandom.FRand() < EmulatedLossRatio)
+	{
+		return true;
+	}
+
+	const auto* Bytes = static_cast<const uint8*>(Data);
+	Driver->Inbox.Enqueue(FPacket{From, TArray<uint8>(Bytes, FMath::DivideAndRoundUp(CountBits, 8)), Driver->GetElapsedTime() + EmulatedLagSeconds});
+	return true;
+}
+
+void UUESTLoopbackNetDriver::SetNetworkEmulation(const float LagSeconds, const float LossRatio, const int32 RandomSeed)
+{
+	EmulatedLagSeconds = FMath::Max(LagSeconds, 0.f);
+	EmulatedLossRatio = FMath::Clamp(LossRatio, 0.f, 1.f);
+	EmulatedLossRandom.Initialize(RandomSeed);
+}
+
+bool UUESTLoopbackNetDriver::IsAvailable() const
+{
+	return true;
+}
+
+bool UUESTLoopbackNetDriver::InitConnectionClass()
+{
+	NetConnectionClass = UUESTLoopbackConnection::StaticClass();
+	return true;
+}
+
+bool UUESTLoopbackNetDriver::InitBase(const bool bInitAsClient, FNetworkNotify* InNotify, const FURL& URL, const bool bReuseAddressAndPort, FString& Error)
+{
+	if (!Super::InitBase(bInitAsClient, InNotify, URL, bReuseAddressAndPort, Error))
+	{
+		return false;
+	}
+
+	auto* SocketSubsystem = GetSocketSubsystem();
+	if (SocketSubsystem == nullptr)
+	{
+		Error = TEXT("Unable to find socket subsystem");
+		return false;
+	}
+
+	// Servers try the requested port first and then the following ones, like UIpNetDriver does when the port is busy
+	auto Port = bInitAsClient ? NextClientPort++ : URL.Port;
+	LocalAddr = MakeLoopbackAddr(*SocketSubsystem, Port);
+	while (Endpoints.Contains(LocalAddr->ToString(true)))
+	{
+		LocalAddr->SetPort(++Port);
+	}
+
+	Endpoints.Add(LocalAddr->ToString(true), this);
+	UE_LOG(LogUESTLoopback, Verbose, TEXT("%s bound to %s"), *GetName(), *LocalAddr->ToString(true));
+
+	return true;
+}
+
+bool UUESTLoopbackNetDriver::InitConnect(FNetworkNotify* InNotify, const FURL& ConnectURL, FString& Error)
+{
+	if (!InitBase(true, InNotify, ConnectURL, false, Error))
+	{
+		return false;
+	}
+
+	ServerConnection = NewObject<UNetConnection>(GetTransientPackage(), NetConnectionClass);
+	ServerConnection->InitLocalConnection(this, nullptr, ConnectURL, USOCK_Pending);
+
+	CreateInitialClientChannels();
+
+	return true;
+}
+
+bool UUESTLoopbackNetDriver::InitListen(FNetworkNotify* InNotify, FURL& LocalURL, const bool bReuseAddressAndPort, FString& Error)
+{
+	if (!InitBase(false, InNotify, LocalURL, bReuseAddressAndPort, Error))
+	{
+		return false;
+	}
+
+	InitConnectionlessHandler();
+
+	LocalURL.Port = LocalAddr->GetPort();
+
+	return true;
+}
+
+void UUESTLoopbackNetDriver::TickDispatch(const float DeltaTime)
+{
+	Super::TickDispatch(DeltaTime);
+
+	// Replies are put into inbox of another driver, so they are received when that driver ticks, same as with sockets.
+	// Lag is the same for all packets, so they become due in the order they were sent.
+	for (const auto* NextPacket = Inbox.Peek(); NextPacket && NextPacket->DeliverTime <= GetElapsedTime(); NextPacket = Inbox.Peek())
+	{
+		FPacket Packet;
+		Inbox.Dequeue(Packet);
+		ReceivePacket(Packet);
+	}
+}
+
+void UUESTLoopbackNetDriver::ReceivePacket(FPacket& Packet)
+{
+	UNetConnection* Connection = nullptr;
+	if (ServerConnection)
+	{
+		Connection = ServerConnection;
+	}
+	else
+	{
+		for (auto* ClientConnection : ClientConnections)
+		{
+			const auto RemoteAddr = ClientConnection ? ClientConnection->GetRemoteAddr() : nullptr;
+			if (RemoteAddr && *RemoteAddr == *Packet.From)
+			{
+				Connection = ClientConnection;
+				break;
+			}
+		}
+	}
+
+	FReceivedPacketView PacketView;
+	PacketView.DataView = {Packet.Data.GetData(), Packet.Data.Num(), ECountUnits::Bytes};
+	PacketView.Address = Packet.From;
+
+	auto bIgnorePacket = false;
+	if (Connection == nullptr)
+	{
+		Connection = ProcessConnectionlessPacket(PacketView);
+		bIgnorePacket = PacketView.DataView.NumBytes() == 0;
+	}
+
+	if (Connection && !bIgnorePacket && !Connection->IsClosingOrClosed())
+	{
+		Connection->ReceivedRawPacket(const_cast<uint8*>(PacketView.DataView.GetData()), PacketView.DataView.NumBytes());
+	}
+}
+
+UNetConnection* UUESTLoopbackNetDriver::ProcessConnectionlessPacket(FReceivedPacketView& PacketView)
+{
+	// Mirrors UIpNetDriver::ProcessConnectionlessPacket: the stateless handshake has to pass before connection is created
+	if (Notify == nullptr || !ConnectionlessHandler.IsValid() || !StatelessConnectComponent.IsValid())
+	{
+		PacketView.DataView = {nullptr, 0, ECountUnits::Bits};
+		return nullptr;
+	}
+
+	const auto StatelessConnect = StatelessConnectComponent.Pin();
+	if (ConnectionlessHandler->IncomingConnectionless(PacketView) != EIncomingResult::Success)
+	{
+		PacketView.DataView = {nullptr, 0, ECountUnits::Bits};
+		return nullptr;
+	}
+
+	auto bRestartedHandshake = false;
+	if (!StatelessConnect->HasPassedChallenge(PacketView.Address, bRestartedHandshake) || bRestartedHandshake)
+	{
+		return nullptr;
+	}
+
+	auto* Connection = NewObject<UNetConnection>(GetTransientPackage(), NetConnectionClass);
+	Connection->InitRemoteConnection(this, nullptr, GetWorld() ? GetWorld()->URL : FURL{}, *PacketView.Address, USOCK_Open);
+
+	int32 ServerSequence = 0;
+	int32 ClientSequence = 0;
+	StatelessConnect->GetChallengeSequence(ServerSequence, ClientSequence);
+	Connection->InitSequence(ClientSequence, ServerSequence);
+
+	if (Connection->Handler.IsValid())
+	{
+		Connection->Handler->BeginHandshaking();
+	}
+
+	Notify->NotifyAcceptedConnection(Connection);
+	AddClientConnection(Connection);
+
+	StatelessConnect->ResetChallengeData();
+
+	return Connection;
+}
+
+void UUESTLoopbackNetDriver::LowLevelSend(const TSharedPtr<const FInternetAddr> Address, void* Data, int32 CountBits, FOutPacketTraits& Traits)
+{
+	if (!Address.IsValid() || !LocalAddr.IsValid())
+	{
+		return;
+	}
+
+	auto* DataToSend = static_cast<uint8*>(Data);
+	if (ConnectionlessHandler.IsValid())
+	{
+		const auto ProcessedData = ConnectionlessHandler->OutgoingConnectionless(Address, DataToSend, CountBits, Traits);
+		if (ProcessedData.bError)
+		{
+			return;
+		}
+
+		DataToSend = ProcessedData.Data;
+		CountBits = ProcessedData.CountBits;
+	}
+
+	SendTo(*Address, LocalAddr.ToSharedRef(), DataToSend, CountBits);
+}
+
+FString UUESTLoopbackNetDriver::LowLevelGetNetworkNumber()
+{
+	return LocalAddr.IsValid() ? LocalAddr->ToString(true) : FString{};
+}
+
+void UUESTLoopbackNetDriver::LowLevelDestroy()
+{
+	Super::LowLevelDestroy();
+
+	if (LocalAddr.IsValid())
+	{
+		Endpoints.Remove(LocalAddr->ToString(true));
+		LocalAddr.Reset();
+	}
+
+	Inbox.Empty();
+}
+
+bool UUESTLoopbackNetDriver::IsNetResourceValid()
+{
+	return LocalAddr.IsValid() && (ServerConnection != nullptr || ConnectionlessHandler.IsValid());
+}
+
+ISocketSubsystem* UUESTLoopbackNetDriver::GetSocketSubsystem()
+{
+	// Only used to create and compare addresses, no sockets are ever opened
+	return ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+}
+
+void UUESTLoopbackConnection::InitLocalConnection(UNetDriver* InDriver, FSocket* InSocket, const FURL& InURL, const EConnectionState InState, const int32 InMaxPacket, const int32 InPacketOverhead)
+{
+	InitBase(InDriver, InSocket, InURL, InState, InMaxPacket == 0 ? LoopbackMaxPacket : InMaxPacket, InPacketOverhead == 0 ? LoopbackPacketOverhead : InPacketOverhead);
+
+	// Any host resolves to loopback, there is nothing but this process to talk to
+	RemoteAddr = MakeLoopbackAddr(*InDriver->GetSocketSubsystem(), InURL.Port);
+
+	InitSendBuffer();
+}
+
+void UUESTLoopbackConnection::InitRemoteConnection(UNetDriver* InDriver, FSocket* InSocket, const FURL& InURL, const FInternetAddr& InRemoteAddr, const EConnectionState InState, const int32 InMaxPacket, const int32 InPacketOverhead)
+{
+	InitBase(InDriver, InSocket, InURL, InState, InMaxPacket == 0 ? LoopbackMaxPacket : InMaxPacket, InPacketOverhead == 0 ? LoopbackPacketOverhead : InPacketOverhead);
+
+	RemoteAddr = InRemoteAddr.Clone();
+	URL.Host = RemoteAddr->ToString(false);
+
+	InitSendBuffer();
+
+	SetClientLoginState(EClientLoginState::LoggingIn);
+	SetExpectedClientLoginMsgType(NMT_Hello);
+}
+
+void UUESTLoopbackConnection::LowLevelSend(void* Data, int32 CountBits, FOutPacketTraits& Traits)
+{
+	auto* DataToSend = static_cast<uint8*>(Data);
+	if (Handler.IsValid() && !Handler->GetRawSend())
+	{
+		const auto ProcessedData = Handler->Outgoing(DataToSend, CountBits, Traits);
+		if (ProcessedData.bError)
+		{
+			return;
+		}
+
+		DataToSend = ProcessedData.Data;
+		CountBits = ProcessedData.CountBits;
+	}
+
+	const auto* LoopbackDriver = Cast<UUESTLoopbackNetDriver>(Driver);
+	if (!RemoteAddr.IsValid() || LoopbackDriver == nullptr || !LoopbackDriver->GetLocalAddr().IsValid())
+	{
+		return;
+	}
+
+	// Packets to a peer that is already gone are dropped, exactly what UDP would do
+	UUESTLoopbackNetDriver::SendTo(*RemoteAddr, LoopbackDriver->GetLocalAddr().ToSharedRef(), DataToSend, CountBits);
+}
+
+FString UUESTLoopbackConnection::LowLevelGetRemoteAddress(const bool bAppendPort)
+{
+	return RemoteAddr.IsValid() ? RemoteAddr->ToString(bAppendPort) : FString{};
+}
+
+FString UUESTLoopbackConnection::LowLevelDescribe()
+{
+	return FString::Printf(TEXT("loopback %s"), *LowLevelGetRemoteAddress(true));
+}
@@ -0,0 +1,76 @@
+#include "UESTTestManifest.h"
+#include "Dom/JsonObject.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "UEST.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogUESTTestManifest, Log, All);
+
+FString FUESTTestManifest::GetDefaultPath()
+{
+	return FPaths::ProjectSavedDir() / TEXT("UEST") / TEXT("TestManifest.json");
+}
+
+FString FUESTTestManifest::Generate()
+{
+	auto RegisteredTests = FUESTTestBase::GetRegisteredTests();
+
+	// Stable order, so manifest only changes when tests change
+	RegisteredTests.Sort([](const FUESTTestBase& A, const FUESTTestBase& B) { return A.GetBeautifiedTestName() < B.GetBeautifiedTestName(); });
+
+	TArray<TSharedPtr<FJsonValue>> Tests;
+	for (const auto* Instance : RegisteredTests)
+	{
+		const auto Test = MakeShared<FJsonObject>();
+		Test->SetStringField(TEXT("Name"), Instance->GetBeautifiedTestName());
+		Test->SetBoolField(TEXT("Disabled"), (static_cast<uint64>(Instance->GetTestFlags()) & static_cast<uint64>(EAutomationTestFlags::Disabled)) != 0);
+		Test->SetBoolField(TEXT("Complex"), Instance->IsComplexTest());
+		Test->SetStringField(TEXT("File"), Instance->GetTestSourceFileName());
+		Test->SetNumberField(TEXT("Line"), Instance->GetTestSourceFileLine());
+
+		auto MethodNames = Instance->GetTestMethodNames();
+		MethodNames.Sort();
+
+		TArray<TSharedPtr<FJsonValue>> Methods;
+		for (const auto& MethodName : MethodNames)
+		{
+			const auto Method = MakeShared<FJsonObject>();
+			Method->SetStringField(TEXT("Name"), MethodName);
+			Method->SetStringField(TEXT("File"), Instance->GetTestSourceFileName(MethodName));
+			Method->SetNumberField(TEXT("Line"), Instance->GetTestSourceFileLine(MethodName));
+			Methods.Add(MakeShared<FJsonValueObject>(Method));
+		}
+
+		Test->SetArrayField(TEXT("Methods"), Methods);
+		Tests.Add(MakeShared<FJsonValueObject>(Test));
+	}
+
+	const auto Manifest = MakeShared<FJsonObject>();
+	Manifest->SetNumberField(TEXT("Version"), Version);
+	Manifest->SetArrayField(TEXT("Tests"), Tests);
+
+	FString Result;
+	const auto Writer = TJsonWriterFactory<>::Create(&Result);
+	FJsonSerializer::Serialize(Manifest, Writer);
+	return Result;
+}
+
+bool FUESTTestManifest::Write(const FString& Path)
+{
+	const auto Manifest = Generate();
+
+	if (FString OldManifest; FFileHelper::LoadFileToString(OldManifest, *Path) && OldManifest == Manifest)
+	{
+		return true;
+	}
+
+	if (!FFileHelper::SaveStringToFile(Manifest, *Path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+	{
+		UE_LOG(LogUESTTestManifest, Warning, TEXT("Failed to write test manifest to %s"), *Path);
+		return false;
+	}
+
+	UE_LOG(LogUESTTestManifest, Log, TEXT("Test manifest written to %s"), *Path);
+	return true;
+}
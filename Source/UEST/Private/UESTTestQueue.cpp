@@ -0,0 +1,151 @@
+#include "UESTTestQueue.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+static const TCHAR* QueueDirName = TEXT("Queue");
+static const TCHAR* ClaimedDirName = TEXT("Claimed");
+static const TCHAR* ResultsDirName = TEXT("Results");
+
+static TSharedRef<FJsonObject> MakeFailedResult(const FString& Message)
+{
+	auto Error = MakeShared<FJsonObject>();
+	Error->SetStringField(TEXT("Message"), Message);
+
+	TArray<TSharedPtr<FJsonValue>> Errors;
+	Errors.Add(MakeShared<FJsonValueObject>(MoveTemp(Error)));
+
+	auto Result = MakeShared<FJsonObject>();
+	Result->SetBoolField(TEXT("Succeeded"), false);
+	Result->SetArrayField(TEXT("Errors"), Errors);
+	return Result;
+}
+
+FUESTTestQueue::FUESTTestQueue(FString RunDir)
+    : RunDir{MoveTemp(RunDir)}
+{
+}
+
+FString FUESTTestQueue::GetPath(const TCHAR* DirName, const int32 Index) const
+{
+	// Files are named by test index, so sorting them by name gives registration order
+	return RunDir / DirName / FString::Printf(TEXT("%06d"), Index);
+}
+
+int32 FUESTTestQueue::GetNumShards(const int32 RequestedShards, const int32 NumTests)
+{
+	return FMath::Clamp(RequestedShards, 1, FMath::Max(1, NumTests));
+}
+
+bool FUESTTestQueue::Enqueue(const TConstArrayView<FUESTQueuedTest> Tests) const
+{
+	auto& FileManager = IFileManager::Get();
+	if (!FileManager.MakeDirectory(*(RunDir / QueueDirName), true) || !FileManager.MakeDirectory(*(RunDir / ClaimedDirName), true) || !FileManager.MakeDirectory(*(RunDir / ResultsDirName), true))
+	{
+		return false;
+	}
+
+	for (int32 Index = 0; Index < Tests.Num(); ++Index)
+	{
+		if (!FFileHelper::SaveStringToFile(Tests[Index].FullName, *GetPath(QueueDirName, Index)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+EUESTTestClaimResult FUESTTestQueue::Claim(int32& OutIndex, FString& OutFullName) const
+{
+	auto& FileManager = IFileManager::Get();
+
+	for (int32 Attempt = 0; Attempt < MaxClaimAttempts; ++Attempt)
+	{
+		TArray<FString> QueuedFiles;
+		FileManager.FindFiles(QueuedFiles, *(RunDir / QueueDirName), nullptr);
+		if (QueuedFiles.IsEmpty())
+		{
+			return EUESTTestClaimResult::QueueEmpty;
+		}
+
+		QueuedFiles.Sort();
+
+		// Rename is atomic, so only one worker can successfully claim a test. If others took all of them, look again
+		for (const auto& FileName : QueuedFiles)
+		{
+			if (!FileManager.Move(*(RunDir / ClaimedDirName / FileName), *(RunDir / QueueDirName / FileName), false, false, false, true))
+			{
+				continue;
+			}
+
+			if (FFileHelper::LoadFileToString(OutFullName, *(RunDir / ClaimedDirName / FileName)))
+			{
+				OutIndex = FCString::Atoi(*FileName);
+				return EUESTTestClaimResult::Claimed;
+			}
+		}
+
+		// Losing every race in a row is unlikely, failing to move files for another reason is not going to fix itself quickly
+		FPlatformProcess::Sleep(0.01f * (1 << Attempt));
+	}
+
+	return EUESTTestClaimResult::Failed;
+}
+
+void FUESTTestQueue::SetResult(const int32 Index, const TSharedRef<FJsonObject>& Result) const
+{
+	FString ResultString;
+	FJsonSerializer::Serialize(Result, TJsonWriterFactory<>::Create(&ResultString));
+	FFileHelper::SaveStringToFile(ResultString, *GetPath(ResultsDirName, Index));
+}
+
+TSharedRef<FJsonObject> FUESTTestQueue::GetResult(const int32 Index) const
+{
+	TSharedPtr<FJsonObject> Result;
+	if (FString ResultString; FFileHelper::LoadFileToString(ResultString, *GetPath(ResultsDirName, Index)))
+	{
+		FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(ResultString), Result);
+	}
+
+	if (Result.IsValid())
+	{
+		return Result.ToSharedRef();
+	}
+
+	const auto bClaimed = IFileManager::Get().FileExists(*GetPath(ClaimedDirName, Index));
+	return MakeFailedResult(bClaimed ? TEXT("Worker process exited while running this test") : TEXT("Test was not run"));
+}
+
+TSharedRef<FJsonObject> FUESTTestQueue::MakeReport(const TConstArrayView<FUESTQueuedTest> Tests, const int32 NumShards, const double DurationSeconds) const
+{
+	TArray<TSharedPtr<FJsonValue>> JsonTests;
+	int32 NumFailed = 0;
+	for (int32 Index = 0; Index < Tests.Num(); ++Index)
+	{
+		const auto& Test = Tests[Index];
+
+		auto Result = GetResult(Index);
+		Result->SetStringField(TEXT("Name"), Test.DisplayName);
+		Result->SetStringField(TEXT("FullName"), Test.FullName);
+		Result->SetStringField(TEXT("SourceFile"), Test.SourceFile);
+		Result->SetNumberField(TEXT("SourceLine"), Test.SourceLine);
+
+		if (!Result->GetBoolField(TEXT("Succeeded")))
+		{
+			++NumFailed;
+		}
+
+		JsonTests.Add(MakeShared<FJsonValueObject>(MoveTemp(Result)));
+	}
+
+	auto Report = MakeShared<FJsonObject>();
+	Report->SetNumberField(TEXT("NumTests"), Tests.Num());
+	Report->SetNumberField(TEXT("NumFailed"), NumFailed);
+	Report->SetNumberField(TEXT("NumShards"), NumShards);
+	Report->SetNumberField(TEXT("DurationSeconds"), DurationSeconds);
+	Report->SetArrayField(TEXT("Tests"), JsonTests);
+	return Report;
+}
@@ -0,0 +1,287 @@
+#include "UESTTestRunnerCommandlet.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Containers/Ticker.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "HAL/ThreadManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "UEST.h"
+#include "UESTTestManifest.h"
+#include "UESTTestQueue.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogUESTTestRunner, Log, All);
+
+static TArray<FUESTQueuedTest> CollectTests(const FString& Filter)
+{
+	TMap<FString, const FUESTTestBase*> UESTTests;
+	for (const auto* Test : FUESTTestBase::GetRegisteredTests())
+	{
+		const auto bDisabled = (static_cast<uint64>(Test->GetTestFlags()) & static_cast<uint64>(EAutomationTestFlags::Disabled)) != 0;
+		if (!bDisabled)
+		{
+			UESTTests.Emplace(Test->GetTestName(), Test);
+		}
+	}
+
+	auto& Framework = FAutomationTestFramework::Get();
+	// Benchmarks would measure each other when run in parallel processes, so they are left out
+	Framework.SetRequestedTestFilter(EAutomationTestFlags_FilterMask & ~EAutomationTestFlags::PerfFilter);
+
+	TArray<FAutomationTestInfo> TestInfos;
+	Framework.GetValidTestNames(TestInfos);
+
+	TArray<FUESTQueuedTest> Result;
+	for (const auto& TestInfo : TestInfos)
+	{
+		if (!TestInfo.GetDisplayName().StartsWith(Filter))
+		{
+			continue;
+		}
+
+		// Complex tests are named "TestName Command"
+		FString TestName = TestInfo.GetTestName();
+		TestInfo.GetTestName().Split(TEXT(" "), &TestName, nullptr);
+
+		if (const auto* Test = UESTTests.FindRef(TestName))
+		{
+			Result.Add({
+			    TestInfo.GetTestName(),
+			    TestInfo.GetDisplayName(),
+			    Test->GetTestSourceFileName(TestInfo.GetTestName()),
+			    Test->GetTestSourceFileLine(TestInfo.GetTestName()),
+			});
+		}
+	}
+
+	return Result;
+}
+
+/**
+ * Engine loop does not run while commandlet is busy, so this does the part of a frame that latent commands may wait for,
+ * like FAutomationWorkerModule gets between its ticks: game thread tasks, core tickers and engine tick.
+ */
+static void TickEngine(const double DeltaSeconds)
+{
+	FApp::UpdateLastTime();
+	FApp::SetCurrentTime(FPlatformTime::Seconds());
+	FApp::SetDeltaTime(DeltaSeconds);
+	++GFrameCounter;
+
+	FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+	FTSTicker::GetCoreTicker().Tick(DeltaSeconds);
+	FThreadManager::Get().Tick();
+
+	if (GEngine)
+	{
+		GEngine->Tick(DeltaSeconds, false);
+	}
+}
+
+static TSharedRef<FJsonObject> RunSingleTest(const FString& FullName, const int32 WorkerIndex)
+{
+	auto& Framework = FAutomationTestFramework::Get();
+
+	const auto StartTime = FPlatformTime::Seconds();
+
+	Framework.StartTestByName(FullName, 0);
+
+	auto FrameTime = FPlatformTime::Seconds();
+	while (!Framework.ExecuteLatentCommands())
+	{
+		const auto Now = FPlatformTime::Seconds();
+		TickEngine(Now - FrameTime);
+		FrameTime = Now;
+	}
+
+	FAutomationTestExecutionInfo ExecutionInfo;
+	const auto bSucceeded = Framework.StopTest(ExecutionInfo);
+
+	TArray<TSharedPtr<FJsonValue>> Errors;
+	TArray<TSharedPtr<FJsonValue>> Warnings;
+	for (const auto& Entry : ExecutionInfo.GetEntries())
+	{
+		auto JsonEntry = MakeShared<FJsonObject>();
+		JsonEntry->SetStringField(TEXT("Message"), Entry.Event.Message);
+		JsonEntry->SetStringField(TEXT("File"), Entry.Filename);
+		JsonEntry->SetNumberField(TEXT("Line"), Entry.LineNumber);
+
+		if (Entry.Event.Type == EAutomationEventType::Error)
+		{
+			Errors.Add(MakeShared<FJsonValueObject>(MoveTemp(JsonEntry)));
+		}
+		else if (Entry.Event.Type == EAutomationEventType::Warning)
+		{
+			Warnings.Add(MakeShared<FJsonValueObject>(MoveTemp(JsonEntry)));
+		}
+	}
+
+	auto Result = MakeShared<FJsonObject>();
+	Result->SetBoolField(TEXT("Succeeded"), bSucceeded && Errors.IsEmpty());
+	Result->SetNumberField(TEXT("DurationSeconds"), FPlatformTime::Seconds() - StartTime);
+	Result->SetNumberField(TEXT("Worker"), WorkerIndex);
+	Result->SetArrayField(TEXT("Errors"), Errors);
+	Result->SetArrayField(TEXT("Warnings"), Warnings);
+	return Result;
+}
+
+UUESTTestRunnerCommandlet::UUESTTestRunnerCommandlet()
+{
+	LogToConsole = true;
+}
+
+int32 UUESTTestRunnerCommandlet::Main(const FString& Params)
+{
+	if (FString RunDir; FParse::Param(*Params, TEXT("Worker")) && FParse::Value(*Params, TEXT("RunDir="), RunDir))
+	{
+		int32 WorkerIndex = 0;
+		FParse::Value(*Params, TEXT("WorkerIndex="), WorkerIndex);
+
+		return RunWorker(RunDir, WorkerIndex);
+	}
+
+	if (FString ManifestPath; FParse::Value(*Params, TEXT("Manifest="), ManifestPath) || FParse::Param(*Params, TEXT("Manifest")))
+	{
+		return FUESTTestManifest::Write(ManifestPath.IsEmpty() ? FUESTTestManifest::GetDefaultPath() : ManifestPath) ? 0 : 1;
+	}
+
+	return RunCoordinator(Params);
+}
+
+int32 UUESTTestRunnerCommandlet::RunCoordinator(const FString& Params)
+{
+	int32 NumShards = FPlatformMisc::NumberOfCores();
+	FParse::Value(*Params, TEXT("Shards="), NumShards);
+
+	FString Filter;
+	FParse::Value(*Params, TEXT("Filter="), Filter);
+
+	FString ReportPath = FPaths::ProjectSavedDir() / TEXT("UEST") / TEXT("Report.json");
+	FParse::Value(*Params, TEXT("Report="), ReportPath);
+
+	double TimeoutSeconds = 0;
+	FParse::Value(*Params, TEXT("Timeout="), TimeoutSeconds);
+
+	const auto Tests = CollectTests(Filter);
+	NumShards = FUESTTestQueue::GetNumShards(NumShards, Tests.Num());
+
+	const auto RunDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectIntermediateDir() / TEXT("UEST") / FGuid::NewGuid().ToString());
+	const FUESTTestQueue Queue{RunDir};
+	if (!Queue.Enqueue(Tests))
+	{
+		UE_LOG(LogUESTTestRunner, Error, TEXT("Failed to create test queue in %s"), *RunDir);
+		return 1;
+	}
+
+	UE_LOG(LogUESTTestRunner, Display, TEXT("Running %d tests in %d processes"), Tests.Num(), NumShards);
+
+	const auto StartTime = FPlatformTime::Seconds();
+
+	FString CommonParams;
+	if (FPaths::IsProjectFilePathSet())
+	{
+		CommonParams = FString::Printf(TEXT("\"%s\" "), *FPaths::GetProjectFilePath());
+	}
+	CommonParams += FString::Printf(TEXT("-run=UESTTestRunner -Worker -RunDir=\"%s\" -unattended -nullrhi -nosplash -nopause"), *RunDir);
+
+	TArray<FProcHandle> Workers;
+	for (int32 WorkerIndex = 0; WorkerIndex < NumShards; ++WorkerIndex)
+	{
+		const auto WorkerParams = FString::Printf(TEXT("%s -WorkerIndex=%d -abslog=\"%s\""), *CommonParams, WorkerIndex, *(RunDir / FString::Printf(TEXT("Worker%d.log"), WorkerIndex)));
+
+		auto Worker = FPlatformProcess::CreateProc(FPlatformProcess::ExecutablePath(), *WorkerParams, false, true, true, nullptr, 0, nullptr, nullptr);
+		if (!Worker.IsValid())
+		{
+			UE_LOG(LogUESTTestRunner, Error, TEXT("Failed to start worker %d"), WorkerIndex);
+			continue;
+		}
+
+		Workers.Add(MoveTemp(Worker));
+	}
+
+	const auto IsAnyWorkerRunning = [&] {
+		for (auto& Worker : Workers)
+		{
+			if (FPlatformProcess::IsProcRunning(Worker))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	};
+
+	while (IsAnyWorkerRunning())
+	{
+		if (TimeoutSeconds > 0 && FPlatformTime::Seconds() - StartTime > TimeoutSeconds)
+		{
+			UE_LOG(LogUESTTestRunner, Error, TEXT("Timeout after %.0f seconds, terminating workers"), TimeoutSeconds);
+			for (auto& Worker : Workers)
+			{
+				FPlatformProcess::TerminateProc(Worker, true);
+			}
+			break;
+		}
+
+		FPlatformProcess::Sleep(0.1f);
+	}
+
+	for (auto& Worker : Workers)
+	{
+		FPlatformProcess::CloseProc(Worker);
+	}
+
+	const auto Report = Queue.MakeReport(Tests, NumShards, FPlatformTime::Seconds() - StartTime);
+
+	const auto NumFailed = static_cast<int32>(Report->GetNumberField(TEXT("NumFailed")));
+	for (const auto& JsonTest : Report->GetArrayField(TEXT("Tests")))
+	{
+		if (const auto& Result = JsonTest->AsObject(); !Result->GetBoolField(TEXT("Succeeded")))
+		{
+			UE_LOG(LogUESTTestRunner, Error, TEXT("%s(%d): %s failed"), *Result->GetStringField(TEXT("SourceFile")), static_cast<int32>(Result->GetNumberField(TEXT("SourceLine"))), *Result->GetStringField(TEXT("Name")));
+		}
+	}
+
+	FString ReportString;
+	FJsonSerializer::Serialize(Report, TJsonWriterFactory<>::Create(&ReportString));
+	FFileHelper::SaveStringToFile(ReportString, *ReportPath);
+
+	UE_LOG(LogUESTTestRunner, Display, TEXT("%d of %d tests failed, report was written to %s"), NumFailed, Tests.Num(), *ReportPath);
+
+	// Keep worker logs around if something went wrong
+	if (NumFailed == 0)
+	{
+		IFileManager::Get().DeleteDirectory(*RunDir, false, true);
+	}
+
+	return NumFailed == 0 ? 0 : 1;
+}
+
+int32 UUESTTestRunnerCommandlet::RunWorker(const FString& RunDir, const int32 WorkerIndex)
+{
+	// Let code that cleans up after automation run (for example, ScopedGame caches) know when it starts and ends
+	auto& Framework = FAutomationTestFramework::Get();
+	Framework.OnBeforeAllTestsEvent.Broadcast();
+
+	const FUESTTestQueue Queue{RunDir};
+	int32 Index = INDEX_NONE;
+	FString FullName;
+	auto ClaimResult = EUESTTestClaimResult::Claimed;
+	while ((ClaimResult = Queue.Claim(Index, FullName)) == EUESTTestClaimResult::Claimed)
+	{
+		UE_LOG(LogUESTTestRunner, Display, TEXT("Worker %d: running %s"), WorkerIndex, *FullName);
+		Queue.SetResult(Index, RunSingleTest(FullName, WorkerIndex));
+	}
+
+	Framework.OnAfterAllTestsEvent.Broadcast();
+
+	// Tests left in queue are reported by coordinator as not run
+	if (ClaimResult == EUESTTestClaimResult::Failed)
+	{
+		UE_LOG(LogUESTTestRunner, Error, TEXT("Worker %d: failed to claim queued tests in %s"), WorkerIndex, *RunDir);
+		return 1;
+	}
+
+	return 0;
+}
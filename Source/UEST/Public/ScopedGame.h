@@ -1,6 +1,11 @@
 #pragma once
 
 #include "Engine/GameInstance.h"
+#include "ScopedGameCheckpoint.h"
+#include "ScopedGameNetStats.h"
+#include "ScopedGameTickProfile.h"
+
+class UNetConnection;
 
 enum class EScopedGameType : uint8
 {
@@ -17,6 +22,12 @@ enum class EScopedGameType : uint8
 	 */
 	Client,
 
+	/**
+	 * Headless client game type connects, gets a PlayerController and replicates like Client does, but has no GameViewportClient.
+	 * Its single local player is not attached to any viewport, so it is cheaper in memory and tick time. Good for load-style tests with many clients.
+	 */
+	HeadlessClient,
+
 	/**
 	 * Empty game type is possibly a not very useful type of game that neither listens to network nor has local players.
 	 */
@@ -34,30 +45,264 @@ enum class EScopedGameConnectError : uint8
 	NoGameState,
 	NoClientPC,
 	NoClientPS,
+	CreateFailed,
+
+	/** Engine reported network failure, for example server rejected login */
+	NetworkFailure,
+
+	/** Engine reported travel failure, for example map could not be loaded */
+	TravelFailure,
+};
+
+enum class EScopedGameGCTiming : uint8
+{
+	/** Collect garbage right after every DestroyGame call and at scope end */
+	AfterEachDestroy,
+
+	/** DestroyGame never collects garbage, all destroyed games are collected at once when FScopedGameInstance goes out of scope */
+	ScopeEnd,
+};
+
+struct FScopedGameGCPolicy
+{
+	EScopedGameGCTiming Timing = EScopedGameGCTiming::AfterEachDestroy;
+
+	/**
+	 * Collect garbage at scope end only once per this many scopes that destroyed games. Scopes that only released games to pool are not counted.
+	 * Zero means that only MemoryThresholdMB triggers collection, so it is rejected when MemoryThresholdMB is not set.
+	 */
+	int32 ScopeInterval = 1;
+
+	/** If non-zero, collect garbage at scope end whenever used physical memory exceeds this amount, regardless of ScopeInterval */
+	uint64 MemoryThresholdMB = 0;
+
+	/** Run expensive UEngine::CheckAndHandleStaleWorldObjectReferences only once per this many garbage collections */
+	int32 StaleWorldCheckInterval = 1;
+};
+
+enum class EScopedGameStreamingMode : uint8
+{
+	/** Every frame, each world waits until all pending level streaming is completed */
+	Blocking,
+
+	/** Every frame, async loading is processed for a limited time and worlds keep ticking while levels stream in */
+	Budgeted,
+};
+
+struct FScopedGameStreamingSettings
+{
+	EScopedGameStreamingMode Mode = EScopedGameStreamingMode::Blocking;
+
+	/** How much time async loading is allowed to take each frame in Budgeted mode. Async loading is process-wide, so this is shared by all games */
+	float BudgetSeconds = 0.005f;
+};
+
+/** Simulated network conditions of in-memory networking, see FScopedGame::WithNetworkEmulation */
+struct FScopedGameNetworkEmulation
+{
+	/** One-way delay of every packet, in seconds of simulated time */
+	float LagSeconds = 0;
+
+	/** Share of packets that are dropped, from 0 to 1 */
+	float LossRatio = 0;
+
+	/** Packet loss is pseudo-random with this seed, so the same test loses the same packets on every run */
+	int32 RandomSeed = 0;
+
+	bool operator==(const FScopedGameNetworkEmulation&) const = default;
+};
+
+/**
+ * Mapping of replicated actors of one world to their counterparts in another world, for example server to client.
+ * Built once and then updated as actors spawn and get destroyed in either world, so lookups are cheap enough to be done every frame.
+ * See FScopedGameInstance::MapReplicatedObjects.
+ */
+class UEST_API FScopedGameObjectMap final : FNoncopyable
+{
+	TWeakObjectPtr<UWorld> From;
+
+	TWeakObjectPtr<UWorld> To;
+
+	TMap<TWeakObjectPtr<const UObject>, TWeakObjectPtr<UObject>> FromToTo;
+
+	TMap<TWeakObjectPtr<const UObject>, TWeakObjectPtr<UObject>> ToToFrom;
+
+	/** Replicated actors of From that have no counterpart in To yet, for example because they are not relevant */
+	TSet<TWeakObjectPtr<AActor>> Pending;
+
+	/** Set when something that may resolve pending actors happened in To */
+	bool bPendingDirty = true;
+
+	/** Number of known net GUIDs in To, new GUIDs may resolve pending actors that were not spawned, such as startup actors */
+	int32 LastNumGUIDs = 0;
+
+	FDelegateHandle FromSpawnedHandle;
+
+	FDelegateHandle FromDestroyedHandle;
+
+	FDelegateHandle ToSpawnedHandle;
+
+	FDelegateHandle ToDestroyedHandle;
+
+	void OnFromActorSpawned(AActor* Actor);
+
+	void OnFromActorDestroyed(AActor* Actor);
+
+	void OnToActorSpawned(AActor* Actor);
+
+	void OnToActorDestroyed(AActor* Actor);
+
+	void Update();
+
+public:
+	[[nodiscard]] explicit FScopedGameObjectMap(UWorld& From, UWorld& To);
+
+	~FScopedGameObjectMap();
+
+	[[nodiscard]] bool Involves(const UWorld& World) const;
+
+	[[nodiscard]] bool Maps(const UWorld& InFrom, const UWorld& InTo) const;
+
+	/**
+	 * Counterpart of Object that belongs to From world, or nullptr if it was not replicated to To world.
+	 * Actors are served from the map, other objects such as components are resolved on each call.
+	 */
+	[[nodiscard]] UObject* Find(const UObject* Object);
+
+	/** Counterpart of Object that belongs to To world, or nullptr if it has no counterpart in From world */
+	[[nodiscard]] UObject* FindReverse(const UObject* Object);
+
+	template<class T>
+	    requires std::is_convertible_v<T*, const UObject*>
+	[[nodiscard]] T* Find(const T* Object)
+	{
+		return Cast<T>(Find(static_cast<const UObject*>(Object)));
+	}
+
+	/** All currently mapped actor pairs, From world object as a key */
+	[[nodiscard]] const TMap<TWeakObjectPtr<const UObject>, TWeakObjectPtr<UObject>>& GetPairs();
+
+	/** Number of From world actors that have counterpart in To world */
+	[[nodiscard]] int32 Num();
+};
+
+/**
+ * Checked reference to FScopedGameObjectMap, see FScopedGameInstance::MapReplicatedObjects.
+ * Map is removed when game of either of its worlds is destroyed, dereferencing the handle after that is an error.
+ */
+class FScopedGameObjectMapHandle final
+{
+	TWeakPtr<FScopedGameObjectMap> ObjectMap;
+
+public:
+	[[nodiscard]] explicit FScopedGameObjectMapHandle(TWeakPtr<FScopedGameObjectMap> ObjectMap)
+	    : ObjectMap{MoveTemp(ObjectMap)}
+	{
+	}
+
+	[[nodiscard]] bool IsValid() const
+	{
+		return ObjectMap.IsValid();
+	}
+
+	/** Map, or nullptr if it was removed */
+	[[nodiscard]] FScopedGameObjectMap* Get() const
+	{
+		return ObjectMap.Pin().Get();
+	}
+
+	FScopedGameObjectMap* operator->() const
+	{
+		auto* Result = Get();
+		checkf(Result, TEXT("Object map was removed because game of one of its worlds was destroyed"));
+		return Result;
+	}
+
+	FScopedGameObjectMap& operator*() const
+	{
+		return *operator->();
+	}
 };
 
 class UEST_API FScopedGameInstance : FNoncopyable
 {
+	friend class FScopedGameObjectMap;
+
 	TSubclassOf<UGameInstance> GameInstanceClass;
 
 	EWorldType::Type WorldType;
 
+	bool bUseMapTemplateCache;
+
+	bool bUsePooling;
+
+	FScopedGameGCPolicy GCPolicy;
+
+	bool bUseVirtualTime;
+
+	TOptional<FScopedGameTickProfile> TickProfile;
+
+	FScopedGameStreamingSettings StreamingSettings;
+
 	TArray<TStrongObjectPtr<UGameInstance>> Games;
 
+	struct FGameTickState final
+	{
+		float IntervalSeconds = 0;
+		float AccumulatedSeconds = 0;
+		bool bFrozen = false;
+	};
+
+	TMap<const UGameInstance*, FGameTickState> GameTickStates;
+
+	/** Connection counters at the moment of last ResetNetStats */
+	TMap<TWeakObjectPtr<const UNetConnection>, FScopedGameNetStats> NetStatsBaselines;
+
+	/** Simulated time since last ResetNetStats */
+	double NetStatsSeconds = 0;
+
+	TArray<TSharedPtr<FScopedGameObjectMap>> ObjectMaps;
+
+	TArray<FScopedGameWorldCheckpoint> Checkpoints;
+
 	static void DestroyGameInternal(UGameInstance& Game);
 
-	void TickInternal(float DeltaSeconds, ELevelTick TickType);
+	static void EndPlayAndShutdownNetDriver(UGameInstance& Game);
+
+	[[nodiscard]] static EScopedGameType GetGameType(const UGameInstance& Game);
+
+	[[nodiscard]] UGameInstance* NewGame(EScopedGameType Type);
+
+	[[nodiscard]] UGameInstance* TakePooledGame(EScopedGameType Type);
+
+	static void ReleaseGameToPool(UGameInstance& Game);
+
+	void DestroyOrReleaseGame(UGameInstance& Game) const;
+
+	void TickInternal(float DeltaSeconds, ELevelTick TickType, const TSet<const UGameInstance*>* GameFilter = nullptr);
+
+	void TickInSteps(float DeltaSeconds, float StepSeconds, ELevelTick TickType, const TSet<const UGameInstance*>* GameFilter);
 
 	[[nodiscard]] static UObject* StaticFindReplicatedObjectIn(UObject* Object, const UWorld* World);
 
-	static void CollectGarbage();
+	static void CollectGarbage(int32 StaleWorldCheckInterval = 1);
+
+	[[nodiscard]] bool IsGarbageCollectionDueAtScopeEnd() const;
 
 	static int32 FindFreePIEInstance();
 
+	[[nodiscard]] static EScopedGameConnectError CheckConnection(const UGameInstance& Game, const FURL& URL);
+
+	[[nodiscard]] static FString GetServerAddress(const UGameInstance& Server);
+
+	static void PreloadMapTemplate(const FURL& URL);
+
+	[[nodiscard]] FScopedGameNetStats GetConnectionNetStats(const UNetConnection& Connection) const;
+
 public:
 	static constexpr auto DefaultStepSeconds = 0.1f;
 
-	[[nodiscard]] explicit FScopedGameInstance(TSubclassOf<UGameInstance> GameInstanceClass, EWorldType::Type WorldType, const TMap<IConsoleVariable*, FString>& CVars);
+	[[nodiscard]] explicit FScopedGameInstance(TSubclassOf<UGameInstance> GameInstanceClass, EWorldType::Type WorldType, const TMap<IConsoleVariable*, FString>& CVars, bool bUseMapTemplateCache, bool bUsePooling, const FScopedGameGCPolicy& GCPolicy, bool bUseVirtualTime, bool bProfileTicks, const FScopedGameStreamingSettings& StreamingSettings, bool bUseInMemoryNetworking, const FScopedGameNetworkEmulation& NetworkEmulation);
 
 	[[nodiscard]] FScopedGameInstance(FScopedGameInstance&& Other);
 
@@ -65,16 +310,80 @@ public:
 
 	UGameInstance* CreateGame(EScopedGameType Type = EScopedGameType::Client, FString MapToLoad = TEXT(""), bool bWaitForConnect = true) UE_LIFETIMEBOUND;
 
-	UGameInstance* CreateClientFor(const UGameInstance& Server, bool bWaitForConnect = true) UE_LIFETIMEBOUND;
+	/** ClientType is either Client or HeadlessClient */
+	UGameInstance* CreateClientFor(const UGameInstance& Server, bool bWaitForConnect = true, EScopedGameType ClientType = EScopedGameType::Client) UE_LIFETIMEBOUND;
+
+	/**
+	 * Connects NumClients clients to Server at once, driving all handshakes in a single tick loop.
+	 * Returned array always has NumClients elements, clients that failed to connect are nullptr.
+	 * If OutErrors is provided, it receives connection result for each client. ClientType is either Client or HeadlessClient.
+	 */
+	TArray<UGameInstance*> CreateClientsFor(const UGameInstance& Server, int32 NumClients, TArray<EScopedGameConnectError>* OutErrors = nullptr, EScopedGameType ClientType = EScopedGameType::Client) UE_LIFETIMEBOUND;
 
 	bool DestroyGame(UGameInstance* Game);
 
 	/** Advances time in all created games by DeltaSeconds in StepSeconds increments */
 	void Tick(float DeltaSeconds, float StepSeconds = DefaultStepSeconds, ELevelTick TickType = LEVELTICK_All);
 
+	/** Advances time only in GamesToTick by DeltaSeconds in StepSeconds increments. Other games stay untouched */
+	void TickOnly(TConstArrayView<const UGameInstance*> GamesToTick, float DeltaSeconds, float StepSeconds = DefaultStepSeconds, ELevelTick TickType = LEVELTICK_All);
+
+	/**
+	 * Makes Game tick at most once per IntervalSeconds of simulated time, receiving accumulated delta time.
+	 * For example, interval of 0.1 with default tick step makes game tick at 10 Hz. Zero interval makes game tick on every step.
+	 */
+	void SetTickInterval(const UGameInstance& Game, float IntervalSeconds);
+
+	/** Frozen game is not ticked at all until unfrozen. Note that other side of network connection may time out meanwhile */
+	void SetFrozen(const UGameInstance& Game, bool bFrozen);
+
+	/** Tick phase timings collected so far, or nullptr if tick profiler was not enabled with FScopedGame::WithTickProfiler */
+	[[nodiscard]] const FScopedGameTickProfile* GetTickProfile() const UE_LIFETIMEBOUND;
+
+	/** Per-frame tick cost of Game. Requires tick profiler to be enabled with FScopedGame::WithTickProfiler */
+	[[nodiscard]] FScopedGameTickStats TickStats(const UGameInstance& Game) const;
+
+	/** Starts recording traffic anew for all games, for example to skip connection handshake and initial replication */
+	void ResetNetStats();
+
+	/** Traffic of all connections of Game since scope was created or since last ResetNetStats */
+	[[nodiscard]] FScopedGameNetStats NetStats(const UGameInstance& Game) const;
+
+	/** Traffic between Server and Client as seen by Server, so OutBytes is what Server sends to Client */
+	[[nodiscard]] FScopedGameNetStats NetStats(const UGameInstance& Server, const UGameInstance& Client) const;
+
 	/** Advances time in all created games in StepSeconds increments until Condition returns true */
 	[[nodiscard]] bool TickUntil(const TFunctionRef<bool()>& Condition, float StepSeconds = DefaultStepSeconds, float MaxWaitTime = 10.f, ELevelTick TickType = LEVELTICK_All);
 
+	/** Advances time in all created games in StepSeconds increments until there is no pending level streaming and async loading */
+	[[nodiscard]] bool TickUntilStreamingComplete(float StepSeconds = DefaultStepSeconds, float MaxWaitTime = 10.f, ELevelTick TickType = LEVELTICK_All);
+
+	/**
+	 * Remembers state of actors in worlds of all created games, so they can be rolled back with RestoreCheckpoint.
+	 * Replaces previously saved checkpoint.
+	 */
+	void SaveCheckpoint();
+
+	/**
+	 * Rolls worlds back to the last SaveCheckpoint: actors spawned since then are destroyed, destroyed ones are respawned
+	 * and properties of all of them are restored. On net clients, only actors that are not replicated are rolled back.
+	 * Games created after checkpoint are not touched. Returns false if there is no checkpoint or some actors could not be restored.
+	 */
+	bool RestoreCheckpoint();
+
+	/** Unroots all map templates loaded by WithMapTemplateCache() so they can be garbage collected. Also happens automatically when automation run ends */
+	static void ClearMapTemplateCache();
+
+	/** Destroys all idle game instances kept by WithPooling(). Also happens automatically when automation run ends */
+	static void DrainGamePool();
+
+	/**
+	 * Mapping of all replicated actors of From to their counterparts in To, kept up to date as actors replicate and get destroyed.
+	 * Prefer it over FindReplicatedObjectIn when many objects are compared, for example in TickUntil conditions.
+	 * DestroyGame of either world removes the map, so returned handle becomes invalid and must not be dereferenced after that.
+	 */
+	[[nodiscard]] FScopedGameObjectMapHandle MapReplicatedObjects(UWorld& From, UWorld& To);
+
 	template<class T = UObject>
 	    requires std::is_convertible_v<T*, const UObject*>
 	[[nodiscard]] T* FindReplicatedObjectIn(T* Object, const UWorld* World) UE_LIFETIMEBOUND
@@ -92,6 +401,22 @@ class UEST_API FScopedGame
 
 	TMap<IConsoleVariable*, FString> CVars;
 
+	bool bUseMapTemplateCache = false;
+
+	bool bUsePooling = false;
+
+	FScopedGameGCPolicy GCPolicy;
+
+	bool bUseVirtualTime = false;
+
+	bool bProfileTicks = false;
+
+	FScopedGameStreamingSettings StreamingSettings;
+
+	bool bUseInMemoryNetworking = false;
+
+	FScopedGameNetworkEmulation NetworkEmulation;
+
 public:
 	[[nodiscard]] FScopedGame();
 
@@ -101,5 +426,47 @@ public:
 
 	[[nodiscard]] FScopedGame& WithConsoleVariable(const FString& Name, FString Value, const bool bReportNonexistentVariable = true) UE_LIFETIMEBOUND;
 
+	/**
+	 * Keeps loaded maps in memory across games and tests, so PIE worlds are duplicated from in-memory template instead of being loaded from disk.
+	 * Only has effect for EWorldType::PIE in editor builds. Templates are released when automation run ends, or earlier with FScopedGameInstance::ClearMapTemplateCache.
+	 */
+	[[nodiscard]] FScopedGame& WithMapTemplateCache(bool bEnable = true) UE_LIFETIMEBOUND;
+
+	/**
+	 * Instead of destroying game instances, puts them into a pool where they are kept alive between tests together with their world context, viewport and local players.
+	 * CreateGame reuses pooled game of the same game instance class, world type and game type, so only map loading has to be done again.
+	 * Pooled games are destroyed when automation run ends, or earlier with FScopedGameInstance::DrainGamePool.
+	 */
+	[[nodiscard]] FScopedGame& WithPooling(bool bEnable = true) UE_LIFETIMEBOUND;
+
+	/** Controls when garbage is collected after games are destroyed, see FScopedGameGCPolicy */
+	[[nodiscard]] FScopedGame& WithGarbageCollectionPolicy(const FScopedGameGCPolicy& InGCPolicy) UE_LIFETIMEBOUND;
+
+	/**
+	 * Advances FApp::GetCurrentTime/GetDeltaTime by simulated DeltaSeconds on every tick, so time-based systems that use engine clock
+	 * observe simulated time and Tick(60) does not need to wait 60 real seconds. Engine clock is restored when last scoped game ends.
+	 * Code that reads FPlatformTime directly still observes wall-clock time, use WithNetworkEmulation instead of PktLag and PktLoss.
+	 */
+	[[nodiscard]] FScopedGame& WithVirtualTime(bool bEnable = true) UE_LIFETIMEBOUND;
+
+	/**
+	 * Records wall-clock time of every tick phase for each game and each frame.
+	 * Summary is added to test log when FScopedGameInstance goes out of scope, see also FScopedGameInstance::GetTickProfile.
+	 */
+	[[nodiscard]] FScopedGame& WithTickProfiler(bool bEnable = true) UE_LIFETIMEBOUND;
+
+	/** Controls how level streaming is processed during tick, see FScopedGameStreamingSettings */
+	[[nodiscard]] FScopedGame& WithStreamingSettings(const FScopedGameStreamingSettings& InStreamingSettings) UE_LIFETIMEBOUND;
+
+	/**
+	 * Replaces sockets of game net driver with in-memory queues, see UUESTLoopbackNetDriver.
+	 * Servers and clients connect the same way as with UIpNetDriver, but packets never leave the process.
+	 * Net driver is replaced process-wide, so nested scopes have to use the same setting and network emulation as the outermost one.
+	 */
+	[[nodiscard]] FScopedGame& WithInMemoryNetworking(bool bEnable = true) UE_LIFETIMEBOUND;
+
+	/** Adds packet lag and loss measured in simulated time to in-memory networking, see FScopedGameNetworkEmulation. Requires WithInMemoryNetworking */
+	[[nodiscard]] FScopedGame& WithNetworkEmulation(const FScopedGameNetworkEmulation& InNetworkEmulation) UE_LIFETIMEBOUND;
+
 	[[nodiscard]] FScopedGameInstance Create() const;
 };
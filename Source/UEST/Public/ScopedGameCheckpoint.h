@@ -0,0 +1,73 @@
+#pragma once
+
+#include "GameFramework/Actor.h"
+
+/**
+ * In-memory snapshot of actors of a single world, see FScopedGameInstance::SaveCheckpoint.
+ * Properties are saved through object serialization, object references are saved by path, so references to respawned actors stay valid.
+ */
+class UEST_API FScopedGameWorldCheckpoint
+{
+	struct FComponentState final
+	{
+		TSubclassOf<UActorComponent> Class;
+		FName Name;
+		TArray<uint8> Data;
+	};
+
+	struct FActorState final
+	{
+		TWeakObjectPtr<AActor> Actor;
+		TWeakObjectPtr<ULevel> Level;
+		TSubclassOf<AActor> Class;
+		FName Name;
+		FTransform Transform;
+
+		/** Actor was loaded with its level rather than spawned, see AActor::IsNetStartupActor */
+		bool bNetStartup = false;
+
+		TArray<uint8> Data;
+		TArray<FComponentState> Components;
+	};
+
+	TWeakObjectPtr<UWorld> World;
+
+	TArray<FActorState> Actors;
+
+	/** Client connections at the moment of checkpoint */
+	TSet<TWeakObjectPtr<const UNetConnection>> Connections;
+
+	/** Net clients only roll back actors they own, replicated actors are rolled back by server */
+	[[nodiscard]] static bool ShouldRollBack(const AActor& Actor);
+
+	static void SaveObject(UObject& Object, TArray<uint8>& OutData);
+
+	static void LoadObject(UObject& Object, const TArray<uint8>& Data);
+
+	[[nodiscard]] static AActor* Respawn(UWorld& World, const FActorState& State);
+
+	/** Destroys components added since checkpoint and recreates ones destroyed since then, so actor has the same components as it had */
+	static void RestoreComponents(AActor& Actor, const FActorState& State);
+
+	/**
+	 * Game state and game mode are restored together with the rest of actors, but players that are still connected stay in the game.
+	 * Rebuilds AGameStateBase::PlayerArray and AGameMode player counters from player states that are alive after restore.
+	 */
+	static void MergeLivePlayers(UWorld& World);
+
+public:
+	[[nodiscard]] explicit FScopedGameWorldCheckpoint(UWorld& World);
+
+	[[nodiscard]] bool IsValid() const
+	{
+		return World.IsValid();
+	}
+
+	/**
+	 * Destroys actors spawned since checkpoint, respawns destroyed ones and restores properties and components of all of them.
+	 * Components are unregistered while their properties are loaded, so render and physics state is recreated from restored values.
+	 * Returns false if world is gone or some actor could not be respawned. Replicated level-placed actors of a server are never respawned,
+	 * because clients destroy their own copies of such actors and cannot get them back.
+	 */
+	bool Restore();
+};
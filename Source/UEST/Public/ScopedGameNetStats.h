@@ -0,0 +1,64 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Network traffic of a game or a single connection since last FScopedGameInstance::ResetNetStats, see FScopedGameInstance::NetStats.
+ * Counted on UNetConnection level, so it covers both generic replication and Iris, including packet handler overhead.
+ */
+struct UEST_API FScopedGameNetStats
+{
+	int64 InBytes = 0;
+
+	int64 OutBytes = 0;
+
+	int64 InPackets = 0;
+
+	int64 OutPackets = 0;
+
+	/** Simulated time that passed while traffic was recorded */
+	double Seconds = 0;
+
+	[[nodiscard]] double GetInBytesPerSecond() const
+	{
+		return Seconds > 0 ? InBytes / Seconds : 0;
+	}
+
+	[[nodiscard]] double GetOutBytesPerSecond() const
+	{
+		return Seconds > 0 ? OutBytes / Seconds : 0;
+	}
+
+	[[nodiscard]] double GetInPacketsPerSecond() const
+	{
+		return Seconds > 0 ? InPackets / Seconds : 0;
+	}
+
+	[[nodiscard]] double GetOutPacketsPerSecond() const
+	{
+		return Seconds > 0 ? OutPackets / Seconds : 0;
+	}
+
+	FScopedGameNetStats& operator+=(const FScopedGameNetStats& Other)
+	{
+		InBytes += Other.InBytes;
+		OutBytes += Other.OutBytes;
+		InPackets += Other.InPackets;
+		OutPackets += Other.OutPackets;
+		return *this;
+	}
+
+	FScopedGameNetStats& operator-=(const FScopedGameNetStats& Other)
+	{
+		InBytes -= Other.InBytes;
+		OutBytes -= Other.OutBytes;
+		InPackets -= Other.InPackets;
+		OutPackets -= Other.OutPackets;
+		return *this;
+	}
+};
+
+static FString ToString(const FScopedGameNetStats& Value)
+{
+	return FString::Printf(TEXT("in %lld bytes in %lld packets, out %lld bytes in %lld packets during %.3f s (in %.1f B/s, out %.1f B/s)"), Value.InBytes, Value.InPackets, Value.OutBytes, Value.OutPackets, Value.Seconds, Value.GetInBytesPerSecond(), Value.GetOutBytesPerSecond());
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "Containers/StaticArray.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Misc/StringBuilder.h"
+#include "Misc/Timespan.h"
+#include "UObject/ObjectKey.h"
+#include "UESTHelpers.h"
+// UEST.h needs to be after UESTHelpers.h
+#include "UEST.h"
+
+class UGameInstance;
+
+enum class EScopedGameTickPhase : uint8
+{
+	/** StaticTick and FTSTicker, done once per frame for all games */
+	EngineTick,
+
+	/** UEngine::TickWorldTravel */
+	WorldTravel,
+
+	/** UWorld::BlockTillLevelStreamingCompleted */
+	LevelStreaming,
+
+	/** UWorld::Tick */
+	WorldTick,
+
+	Num,
+};
+
+struct UEST_API FScopedGameFrameProfile
+{
+	using FPhaseSeconds = TStaticArray<double, static_cast<int32>(EScopedGameTickPhase::Num)>;
+
+	/** Tick groups that UWorld::Tick runs in order, TG_NewlySpawned is not a group of its own */
+	static constexpr int32 NumTickGroups = TG_NewlySpawned;
+
+	using FTickGroupSeconds = TStaticArray<double, NumTickGroups>;
+
+	/** GFrameCounter value of this frame */
+	uint64 FrameCounter = 0;
+
+	/** Simulated delta time of this frame */
+	float DeltaSeconds = 0;
+
+	/** Wall-clock time spent ticking this frame */
+	double TotalSeconds = 0;
+
+	/** Wall-clock time spent in StaticTick, FTSTicker and budgeted async loading */
+	double EngineTickSeconds = 0;
+
+	/** Part of EngineTickSeconds spent in ProcessAsyncLoading, only non-zero in EScopedGameStreamingMode::Budgeted */
+	double AsyncLoadingSeconds = 0;
+
+	/** Wall-clock time spent in each phase by each game, indexed by game index of FScopedGameTickProfile */
+	TArray<FPhaseSeconds> GamePhaseSeconds;
+
+	/**
+	 * Part of WorldTick phase spent in each tick group by each game, indexed by game index.
+	 * This is where actor and component ticks run, so it tells which kind of work is slow without timing every tick function
+	 */
+	TArray<FTickGroupSeconds> GameTickGroupSeconds;
+
+	/** Games that ticked this frame, indexed by game index */
+	TBitArray<> TickedGames;
+};
+
+/**
+ * Per-frame tick cost of a single game, see FScopedGameInstance::TickStats.
+ */
+struct UEST_API FScopedGameTickStats
+{
+	FString GameName;
+
+	/** Wall-clock time spent ticking the game in each frame it was ticked */
+	TArray<double> FrameSeconds;
+
+	[[nodiscard]] double GetAverageSeconds() const;
+
+	[[nodiscard]] double GetMaxSeconds() const;
+
+	/** Percentile is in [0, 1] range, for example 0.95 */
+	[[nodiscard]] double GetPercentileSeconds(double Percentile) const;
+};
+
+static FString ToString(const FScopedGameTickStats& Value)
+{
+	return FString::Printf(TEXT("%s ticked %d frames, average %.3f ms, max %.3f ms"), *Value.GameName, Value.FrameSeconds.Num(), Value.GetAverageSeconds() * 1000, Value.GetMaxSeconds() * 1000);
+}
+
+/**
+ * Wall-clock time spent in each tick phase by each game of FScopedGameInstance, see FScopedGame::WithTickProfiler.
+ */
+class UEST_API FScopedGameTickProfile
+{
+	/** Index of every game that is currently part of the scope */
+	TMap<TObjectKey<UGameInstance>, int32> GameIndices;
+
+public:
+	TArray<FScopedGameFrameProfile> Frames;
+
+	/** Names of all games that were ever profiled, by game index. Games are numbered in order they were added, so names are unique within the profile */
+	TArray<FString> GameNames;
+
+	/** Gives Game a new game index. Game that is added again after being removed, for example when taken back from pool, is profiled as a new game */
+	int32 AddGame(const UGameInstance& Game);
+
+	void RemoveGame(const UGameInstance& Game);
+
+	/** Index of Game in GameNames and frame profiles, or INDEX_NONE if it is not profiled */
+	[[nodiscard]] int32 FindGameIndex(const UGameInstance& Game) const;
+
+	/** Frame that has room for all profiled games */
+	FScopedGameFrameProfile& AddFrame();
+
+	/** Total wall-clock time spent in Phase by all games */
+	[[nodiscard]] double GetPhaseSeconds(EScopedGameTickPhase Phase) const;
+
+	/** Total wall-clock time spent in TickGroup by all games */
+	[[nodiscard]] double GetTickGroupSeconds(ETickingGroup TickGroup) const;
+
+	/** Total wall-clock time spent in TickGroup by Game */
+	[[nodiscard]] double GetGameTickGroupSeconds(const UGameInstance& Game, ETickingGroup TickGroup) const;
+
+	/** Total wall-clock time spent ticking Game */
+	[[nodiscard]] double GetGameSeconds(const UGameInstance& Game) const;
+
+	/** Total wall-clock time spent ticking game named GameName */
+	[[nodiscard]] double GetGameSeconds(const FString& GameName) const;
+
+	/** Total wall-clock time spent ticking game with GameIndex */
+	[[nodiscard]] double GetGameSeconds(int32 GameIndex) const;
+
+	/** Per-frame tick cost of Game */
+	[[nodiscard]] FScopedGameTickStats GetGameStats(const UGameInstance& Game) const;
+
+	/** Total wall-clock time spent ticking all games */
+	[[nodiscard]] double GetTotalSeconds() const;
+
+	/** Up to Count games that took most time to tick, slowest first */
+	[[nodiscard]] TArray<TPair<FString, double>> GetSlowestGames(int32 Count) const;
+
+	/** Up to Count frames that took most time to tick, slowest first */
+	[[nodiscard]] TArray<const FScopedGameFrameProfile*> GetSlowestFrames(int32 Count) const;
+
+	/** Human-readable summary with top phases, tick groups, games and frames */
+	[[nodiscard]] FString GetSummary(int32 TopCount = 5) const;
+};
+
+namespace UEST::Matchers
+{
+	struct WithinTickBudget final : FNoncopyable
+	{
+		const FTimespan Budget;
+
+		explicit WithinTickBudget(const FTimespan Budget)
+		    : Budget{Budget}
+		{
+		}
+
+		template<typename T>
+		    requires(std::is_same_v<std::decay_t<T>, FScopedGameTickStats>)
+		bool Matches(const FScopedGameTickStats& Value) const
+		{
+			return Value.GetAverageSeconds() <= Budget.GetTotalSeconds();
+		}
+
+		void Describe(FStringBuilderBase& Out) const
+		{
+			Out.Appendf(TEXT("tick within %.3f ms on average"), Budget.GetTotalMilliseconds());
+		}
+	};
+} // namespace UEST::Matchers
+
+namespace Is
+{
+	/** Usage: ASSERT_THAT(Tester.TickStats(Server), Is::WithinTickBudget(FTimespan::FromMilliseconds(2))) */
+	using WithinTickBudget = UEST::Matchers::WithinTickBudget;
+
+	namespace Not
+	{
+		using WithinTickBudget = UEST::Matchers::Not<UEST::Matchers::WithinTickBudget, FTimespan>;
+	} // namespace Not
+} // namespace Is
@@ -9,9 +9,24 @@
 #endif
 
 #include "Misc/AutomationTest.h"
+#include "Misc/StringBuilder.h"
+#include "UESTBenchmark.h"
+#include "UESTBulkKernels.h"
 
 namespace UEST
 {
+	template<typename M>
+	concept DescribableMatcher = requires(const M m, FStringBuilderBase& Out) {
+		{
+			m.Describe(Out)
+		};
+	} || requires(const M m) {
+		// Matchers that allocate their description, kept for compatibility
+		{
+			m.Describe()
+		} -> UE::same_as<FString>;
+	};
+
 	template<typename M, typename... P>
 	concept Matcher = requires(M const m, P... p) {
 		{
@@ -19,13 +34,120 @@ namespace UEST
 		};
 		// TODO: Can we require that there exists such template? template<typename T> bool M::Matches(const<T>&)
 		//{ m.Matches(t) } -> std::same_as<bool>;
-		{
-			m.Describe()
-		} -> UE::same_as<FString>;
+		requires DescribableMatcher<M>;
 	};
 
+	/** How many elements of a container are written into failure message */
+	constexpr int32 MaxDescribedElements = 16;
+
+	/** Writes value into failure message, values without own overload are written using ToString from UESTHelpers.h */
+	template<typename T>
+	void AppendValue(FStringBuilderBase& Out, const T& Value)
+	{
+		Out << ToString(Value);
+	}
+
+	inline void AppendValue(FStringBuilderBase& Out, const FString& Value)
+	{
+		Out << Value;
+	}
+
+	template<typename T, typename Allocator>
+	void AppendValue(FStringBuilderBase& Out, const TArray<T, Allocator>& Value);
+
+	template<typename T, typename SizeType>
+	void AppendValue(FStringBuilderBase& Out, const TArrayView<T, SizeType> Value)
+	{
+		const auto NumDescribed = FMath::Min<int64>(Value.Num(), MaxDescribedElements);
+
+		Out << TEXT('[');
+		for (int64 Index = 0; Index < NumDescribed; ++Index)
+		{
+			if (Index > 0)
+			{
+				Out << TEXT(", ");
+			}
+
+			AppendValue(Out, Value[Index]);
+		}
+
+		if (Value.Num() > NumDescribed)
+		{
+			Out.Appendf(TEXT(", ... %lld more"), static_cast<int64>(Value.Num() - NumDescribed));
+		}
+		Out << TEXT(']');
+	}
+
+	template<typename T, typename Allocator>
+	void AppendValue(FStringBuilderBase& Out, const TArray<T, Allocator>& Value)
+	{
+		AppendValue(Out, MakeArrayView(Value));
+	}
+
+	template<DescribableMatcher M>
+	void DescribeMatcher(FStringBuilderBase& Out, const M& Matcher)
+	{
+		if constexpr (requires { Matcher.Describe(Out); })
+		{
+			Matcher.Describe(Out);
+		}
+		else
+		{
+			Out << Matcher.Describe();
+		}
+	}
+
 	namespace Matchers
 	{
+		/**
+		 * Expected value of a matcher: lvalues are referenced and temporaries are moved in, so constructing a matcher never copies non-trivial values.
+		 * Matchers are destroyed at the end of assertion, referenced values outlive them.
+		 */
+		template<typename T>
+		class TExpected final : FNoncopyable
+		{
+			const T* Referenced = nullptr;
+			TOptional<T> Owned;
+
+		public:
+			explicit TExpected(const T& Value)
+			    : Referenced{&Value}
+			{
+			}
+
+			explicit TExpected(T&& Value)
+			    : Owned{MoveTemp(Value)}
+			{
+			}
+
+			[[nodiscard]] const T& Get() const
+			{
+				return Referenced ? *Referenced : Owned.GetValue();
+			}
+		};
+
+		/**
+		 * Trivially copyable values, including all scalars, are copied. They are cheap to copy, and an lvalue that cannot be referenced,
+		 * such as a bit field, binds to a temporary that is gone by the time matcher is used.
+		 */
+		template<typename T>
+		    requires std::is_trivially_copyable_v<T>
+		class TExpected<T> final : FNoncopyable
+		{
+			const T Value;
+
+		public:
+			explicit TExpected(const T& Value)
+			    : Value{Value}
+			{
+			}
+
+			[[nodiscard]] const T& Get() const
+			{
+				return Value;
+			}
+		};
+
 		struct Null final
 		{
 			template<typename T>
@@ -39,9 +161,9 @@ namespace UEST
 				return Value == nullptr;
 			}
 
-			FString Describe() const
+			void Describe(FStringBuilderBase& Out) const
 			{
-				return TEXT("be nullptr");
+				Out << TEXT("be nullptr");
 			}
 		};
 
@@ -54,9 +176,9 @@ namespace UEST
 				return Value;
 			}
 
-			FString Describe() const
+			void Describe(FStringBuilderBase& Out) const
 			{
-				return TEXT("be true");
+				Out << TEXT("be true");
 			}
 		};
 
@@ -69,9 +191,9 @@ namespace UEST
 				return !Value;
 			}
 
-			FString Describe() const
+			void Describe(FStringBuilderBase& Out) const
 			{
-				return TEXT("be false");
+				Out << TEXT("be false");
 			}
 		};
 
@@ -88,9 +210,9 @@ namespace UEST
 				return Value.IsEmpty();
 			}
 
-			FString Describe() const
+			void Describe(FStringBuilderBase& Out) const
 			{
-				return TEXT("be empty");
+				Out << TEXT("be empty");
 			}
 		};
 
@@ -107,19 +229,24 @@ namespace UEST
 				return Value.IsValid();
 			}
 
-			FString Describe() const
+			void Describe(FStringBuilderBase& Out) const
 			{
-				return TEXT("be valid");
+				Out << TEXT("be valid");
 			}
 		};
 
 		template<typename P>
 		struct EqualTo final : FNoncopyable
 		{
-			const P Expected;
+			const TExpected<P> Expected;
 
-			explicit EqualTo(P Expected)
-			    : Expected(MoveTemp(Expected))
+			explicit EqualTo(const P& Expected)
+			    : Expected{Expected}
+			{
+			}
+
+			explicit EqualTo(P&& Expected)
+			    : Expected{MoveTemp(Expected)}
 			{
 			}
 
@@ -131,12 +258,13 @@ namespace UEST
 			    }
 			bool Matches(const T& Value) const
 			{
-				return Value == Expected;
+				return Value == Expected.Get();
 			}
 
-			FString Describe() const
+			void Describe(FStringBuilderBase& Out) const
 			{
-				return FString::Printf(TEXT("be equal to %s"), *ToString(Expected));
+				Out << TEXT("be equal to ");
+				AppendValue(Out, Expected.Get());
 			}
 		};
 
@@ -144,51 +272,65 @@ namespace UEST
 		// TODO: Add concepts
 		struct NearlyEqualTo final : FNoncopyable
 		{
-			const E Expected;
+			const TExpected<E> Expected;
 			const T Tolerance;
 
-			explicit NearlyEqualTo(E Expected, T Tolerance = UE_SMALL_NUMBER)
+			explicit NearlyEqualTo(const E& Expected, T Tolerance = UE_SMALL_NUMBER)
 			    : Expected{Expected}
 			    , Tolerance{Tolerance}
 			{
 			}
 
+			explicit NearlyEqualTo(E&& Expected, T Tolerance = UE_SMALL_NUMBER)
+			    : Expected{MoveTemp(Expected)}
+			    , Tolerance{Tolerance}
+			{
+			}
+
 			template<typename>
 			bool Matches(const FVector& Value) const
 			{
-				return Value.Equals(Expected, Tolerance);
+				return Value.Equals(Expected.Get(), Tolerance);
 			}
 
 			template<typename>
 			bool Matches(const FRotator& Value) const
 			{
-				return Value.Equals(Expected, Tolerance);
+				return Value.Equals(Expected.Get(), Tolerance);
 			}
 
 			template<typename>
 			bool Matches(const float& Value) const
 			{
-				return FMath::IsNearlyEqual(Value, Expected, Tolerance);
+				return FMath::IsNearlyEqual(Value, Expected.Get(), Tolerance);
 			}
 
 			template<typename>
 			bool Matches(const double& Value) const
 			{
-				return FMath::IsNearlyEqual(Value, Expected, Tolerance);
+				return FMath::IsNearlyEqual(Value, Expected.Get(), Tolerance);
 			}
 
-			FString Describe() const
+			void Describe(FStringBuilderBase& Out) const
 			{
-				return FString::Printf(TEXT("be nearly equal to %s with tolerance %s"), *ToString(Expected), *ToString(Tolerance));
+				Out << TEXT("be nearly equal to ");
+				AppendValue(Out, Expected.Get());
+				Out << TEXT(" with tolerance ");
+				AppendValue(Out, Tolerance);
 			}
 		};
 
 		template<typename P>
 		struct LessThan final : FNoncopyable
 		{
-			const P Expected;
+			const TExpected<P> Expected;
 
-			explicit LessThan(P Expected)
+			explicit LessThan(const P& Expected)
+			    : Expected{Expected}
+			{
+			}
+
+			explicit LessThan(P&& Expected)
 			    : Expected{MoveTemp(Expected)}
 			{
 			}
@@ -201,21 +343,27 @@ namespace UEST
 			    }
 			bool Matches(const T& Value) const
 			{
-				return Value < Expected;
+				return Value < Expected.Get();
 			}
 
-			FString Describe() const
+			void Describe(FStringBuilderBase& Out) const
 			{
-				return FString::Printf(TEXT("be less than %s"), *ToString(Expected));
+				Out << TEXT("be less than ");
+				AppendValue(Out, Expected.Get());
 			}
 		};
 
 		template<typename P>
 		struct LessThanOrEqualTo final : FNoncopyable
 		{
-			const P Expected;
+			const TExpected<P> Expected;
 
-			explicit LessThanOrEqualTo(P Expected)
+			explicit LessThanOrEqualTo(const P& Expected)
+			    : Expected{Expected}
+			{
+			}
+
+			explicit LessThanOrEqualTo(P&& Expected)
 			    : Expected{MoveTemp(Expected)}
 			{
 			}
@@ -228,21 +376,27 @@ namespace UEST
 			    }
 			bool Matches(const T& Value) const
 			{
-				return Value <= Expected;
+				return Value <= Expected.Get();
 			}
 
-			FString Describe() const
+			void Describe(FStringBuilderBase& Out) const
 			{
-				return FString::Printf(TEXT("be less than or equal to %s"), *ToString(Expected));
+				Out << TEXT("be less than or equal to ");
+				AppendValue(Out, Expected.Get());
 			}
 		};
 
 		template<typename P>
 		struct GreaterThan final : FNoncopyable
 		{
-			const P Expected;
+			const TExpected<P> Expected;
 
-			explicit GreaterThan(P Expected)
+			explicit GreaterThan(const P& Expected)
+			    : Expected{Expected}
+			{
+			}
+
+			explicit GreaterThan(P&& Expected)
 			    : Expected{MoveTemp(Expected)}
 			{
 			}
@@ -255,21 +409,27 @@ namespace UEST
 			    }
 			bool Matches(const T& Value) const
 			{
-				return Value > Expected;
+				return Value > Expected.Get();
 			}
 
-			FString Describe() const
+			void Describe(FStringBuilderBase& Out) const
 			{
-				return FString::Printf(TEXT("be greater than %s"), *ToString(Expected));
+				Out << TEXT("be greater than ");
+				AppendValue(Out, Expected.Get());
 			}
 		};
 
 		template<typename P>
 		struct GreaterThanOrEqualTo final : FNoncopyable
 		{
-			const P Expected;
+			const TExpected<P> Expected;
 
-			explicit GreaterThanOrEqualTo(P Expected)
+			explicit GreaterThanOrEqualTo(const P& Expected)
+			    : Expected{Expected}
+			{
+			}
+
+			explicit GreaterThanOrEqualTo(P&& Expected)
 			    : Expected{MoveTemp(Expected)}
 			{
 			}
@@ -282,12 +442,13 @@ namespace UEST
 			    }
 			bool Matches(const T& Value) const
 			{
-				return Value >= Expected;
+				return Value >= Expected.Get();
 			}
 
-			FString Describe() const
+			void Describe(FStringBuilderBase& Out) const
 			{
-				return FString::Printf(TEXT("be greater than or equal to %s"), *ToString(Expected));
+				Out << TEXT("be greater than or equal to ");
+				AppendValue(Out, Expected.Get());
 			}
 		};
 
@@ -299,9 +460,10 @@ namespace UEST
 			{
 				return FMath::IsNaN(Value);
 			}
-			FString Describe() const
+
+			void Describe(FStringBuilderBase& Out) const
 			{
-				return TEXT("be nullptr");
+				Out << TEXT("be NaN");
 			}
 		};
 
@@ -336,9 +498,177 @@ namespace UEST
 				return Value >= From && Value <= To;
 			}
 
-			FString Describe() const
+			void Describe(FStringBuilderBase& Out) const
+			{
+				Out << TEXT("be in range from ");
+				AppendValue(Out, From);
+				Out << TEXT(" to ");
+				AppendValue(Out, To);
+			}
+		};
+
+		/** Array last matched by a bulk matcher, so its elements are only formatted when assertion fails */
+		struct FMatchedElements final
+		{
+			const void* Data = nullptr;
+
+			void (*AppendElement)(FStringBuilderBase& Out, const void* Data, int32 Index) = nullptr;
+
+			template<typename T>
+			void Set(const TConstArrayView<T> Values)
 			{
-				return FString::Printf(TEXT("be in range from %s to %s"), *::ToString(From), *::ToString(To));
+				Data = Values.GetData();
+				AppendElement = [](FStringBuilderBase& Out, const void* InData, const int32 Index) {
+					AppendValue(Out, static_cast<const T*>(InData)[Index]);
+				};
+			}
+
+			void Append(FStringBuilderBase& Out, const int32 Index) const
+			{
+				AppendElement(Out, Data, Index);
+			}
+		};
+
+		/**
+		 * Bulk version of NearlyEqualTo for arrays of float, double, vectors and rotators.
+		 * Expected values are not copied, so they must outlive the assertion.
+		 */
+		template<typename E, typename T = typename Bulk::TComponentOf<E>::Type>
+		struct AllNearlyEqualTo final : FNoncopyable
+		{
+			const TConstArrayView<E> Expected;
+			const T Tolerance;
+
+			/** Referenced until failure is described, assertion keeps matched value alive for that long */
+			mutable TConstArrayView<E> MatchedValues;
+			mutable Bulk::FMismatches Mismatches;
+
+			explicit AllNearlyEqualTo(const TConstArrayView<E> Expected, T Tolerance = UE_SMALL_NUMBER)
+			    : Expected{Expected}
+			    , Tolerance{Tolerance}
+			{
+			}
+
+			/** View of a temporary array would dangle by the time assertion is evaluated */
+			AllNearlyEqualTo(TArray<E>&& Expected, T Tolerance = UE_SMALL_NUMBER) = delete;
+
+			template<typename>
+			bool Matches(const TConstArrayView<E> Values) const
+			{
+				MatchedValues = Values;
+				Mismatches.Reset();
+				if (Values.Num() != Expected.Num())
+				{
+					return false;
+				}
+
+				if constexpr (Bulk::IsRotator<E>)
+				{
+					// Rotator components are compared after angle normalization, which has no vector kernel
+					for (auto Index = 0; Index < Values.Num(); ++Index)
+					{
+						if (!Values[Index].Equals(Expected[Index], Tolerance))
+						{
+							Mismatches.Add(Index);
+						}
+					}
+				}
+				else
+				{
+					using FComponent = typename Bulk::TComponentOf<E>::Type;
+					Bulk::FindNotNearlyEqual(Bulk::Flatten(Values), Bulk::Flatten(Expected), static_cast<FComponent>(Tolerance), Bulk::ComponentsOf<E>, Mismatches);
+				}
+
+				return Mismatches.Num == 0;
+			}
+
+			void Describe(FStringBuilderBase& Out) const
+			{
+				if (MatchedValues.Num() != Expected.Num())
+				{
+					Out.Appendf(TEXT("have %d elements to be compared with expected values"), Expected.Num());
+					return;
+				}
+
+				Out << TEXT("all be nearly equal to expected values with tolerance ");
+				AppendValue(Out, Tolerance);
+				Bulk::DescribeMismatches(Out, Mismatches, [&](const int32 Index) {
+					AppendValue(Out, MatchedValues[Index]);
+					Out << TEXT(" instead of ");
+					AppendValue(Out, Expected[Index]);
+				});
+			}
+		};
+
+		/** Bulk version of InRange for arrays of float, double, vectors and rotators, every component is checked against the same range */
+		template<typename T>
+		struct AllInRange final : FNoncopyable
+		{
+			const T From;
+			const T To;
+
+			mutable FMatchedElements MatchedElements;
+			mutable Bulk::FMismatches Mismatches;
+
+			explicit AllInRange(T From, T To)
+			    : From{From}
+			    , To{To}
+			{
+			}
+
+			template<typename A>
+			bool Matches(const A& Values) const
+			{
+				Mismatches.Reset();
+				if (!ensureAlwaysMsgf(From <= To, TEXT("Invalid range, %s is greater than %s"), *ToString(From), *ToString(To)))
+				{
+					return false;
+				}
+
+				using FElement = std::remove_const_t<typename A::ElementType>;
+				using FComponent = typename Bulk::TComponentOf<FElement>::Type;
+				const auto View = Bulk::ViewOf(Values);
+				MatchedElements.Set(View);
+				Bulk::FindNotInRange(Bulk::Flatten(View), static_cast<FComponent>(From), static_cast<FComponent>(To), Bulk::ComponentsOf<FElement>, Mismatches);
+
+				return Mismatches.Num == 0;
+			}
+
+			void Describe(FStringBuilderBase& Out) const
+			{
+				Out << TEXT("all be in range from ");
+				AppendValue(Out, From);
+				Out << TEXT(" to ");
+				AppendValue(Out, To);
+				Bulk::DescribeMismatches(Out, Mismatches, [&](const int32 Index) {
+					MatchedElements.Append(Out, Index);
+				});
+			}
+		};
+
+		/** Tests that arrays of float, double, vectors and rotators have neither NaN nor infinite components */
+		struct AllFinite final : FNoncopyable
+		{
+			mutable FMatchedElements MatchedElements;
+			mutable Bulk::FMismatches Mismatches;
+
+			template<typename A>
+			bool Matches(const A& Values) const
+			{
+				using FElement = std::remove_const_t<typename A::ElementType>;
+				const auto View = Bulk::ViewOf(Values);
+				MatchedElements.Set(View);
+				Bulk::FindNotFinite(Bulk::Flatten(View), Bulk::ComponentsOf<FElement>, Mismatches);
+
+				return Mismatches.Num == 0;
+			}
+
+			void Describe(FStringBuilderBase& Out) const
+			{
+				Out << TEXT("all be finite");
+				Bulk::DescribeMismatches(Out, Mismatches, [&](const int32 Index) {
+					MatchedElements.Append(Out, Index);
+				});
 			}
 		};
 
@@ -348,8 +678,10 @@ namespace UEST
 		{
 			M Nested;
 
-			explicit Not(P... Args)
-			    : Nested{MoveTemp(Args)...}
+			/** Arguments are forwarded, so nested matcher can reference or take ownership of expected value */
+			template<typename... A>
+			explicit Not(A&&... Args)
+			    : Nested{Forward<A>(Args)...}
 			{
 			}
 
@@ -364,9 +696,10 @@ namespace UEST
 				return !Nested.template Matches<T>(Value);
 			}
 
-			FString Describe() const
+			void Describe(FStringBuilderBase& Out) const
 			{
-				return FString::Printf(TEXT("not %s"), *Nested.Describe());
+				Out << TEXT("not ");
+				DescribeMatcher(Out, Nested);
 			}
 		};
 	} // namespace Matchers
@@ -412,6 +745,14 @@ namespace Is
 	template<typename T>
 	using InRange = UEST::Matchers::InRange<T>;
 
+	template<typename E, typename T = typename UEST::Bulk::TComponentOf<E>::Type>
+	using AllNearlyEqualTo = UEST::Matchers::AllNearlyEqualTo<E, T>;
+
+	template<typename T>
+	using AllInRange = UEST::Matchers::AllInRange<T>;
+
+	using AllFinite = UEST::Matchers::AllFinite;
+
 	namespace Not
 	{
 		const inline auto Null = UEST::Matchers::Not<UEST::Matchers::Null>{};
@@ -450,6 +791,29 @@ namespace Is
 	} // namespace Not
 } // namespace Is
 
+namespace UEST
+{
+	/**
+	 * Adds failed assertion as an error of currently running automation test, without walking the stack.
+	 * Message ends with FileName(FileLine), so logs and IDEs can link it to the assertion.
+	 * Falls back to ensure when UEST.CaptureAssertionStack console variable is set or when no test is running.
+	 */
+	UEST_API void ReportAssertionFailure(FStringView Message, const TCHAR* FileName, int32 FileLine);
+
+	/** Failure message is only formatted here, so passing assertions neither format nor allocate */
+	template<typename T, typename M>
+	FORCENOINLINE void ReportAssertionFailure(const TCHAR* Expression, const T& Value, const M& Matcher, const TCHAR* FileName, const int32 FileLine)
+	{
+		TStringBuilder<512> Message;
+		Message << Expression << TEXT(": ");
+		AppendValue(Message, Value);
+		Message << TEXT(" must ");
+		DescribeMatcher(Message, Matcher);
+
+		ReportAssertionFailure(Message.ToView(), FileName, FileLine);
+	}
+} // namespace UEST
+
 #define UEST_MATCHER_HELPER(...) Is::True
 #define UEST_MATCHER_HELPERN(...) __VA_ARGS__
 
@@ -459,8 +823,9 @@ namespace Is
 	{ \
 		const auto& _M = UEST_MATCHER_HELPER##__VA_OPT__(N)(__VA_ARGS__); \
 		const auto& _V = Value; \
-		if (!ensureAlwaysMsgf(_M.template Matches<std::decay_t<decltype(_V)>>(_V), TEXT("%s: %s must %s"), TEXT(#Value), *ToString(_V), *_M.Describe())) \
+		if (!_M.template Matches<std::decay_t<decltype(_V)>>(_V)) [[unlikely]] \
 		{ \
+			UEST::ReportAssertionFailure(TEXT(#Value), _V, _M, TEXT(__FILE__), __LINE__); \
 			return; \
 		} \
 	} while (false)
@@ -476,8 +841,6 @@ class UEST_API FUESTTestBase : public FAutomationTestBase
 		const int32 FileLine;
 	};
 
-	TMap<FString, FTestMethodInfo> TestMethods;
-
 protected:
 	FUESTTestBase(const FString& InName, bool bIsComplex);
 
@@ -489,17 +852,52 @@ protected:
 
 	virtual void TearDown() {}
 
+	/** Links itself into owning test, so test objects are constructed without allocating anything per method */
 	struct FUESTMethodRegistrar final : FNoncopyable
 	{
-		FUESTMethodRegistrar(FUESTTestBase& Test, const TCHAR* Name, FTestMethodInfo&& Info)
+		FUESTMethodRegistrar(FUESTTestBase& Test, const TCHAR* InName, FTestMethodInfo&& InInfo)
+		    : Name{InName}
+		    , Info{MoveTemp(InInfo)}
 		{
-			Test.TestMethods.Emplace(Name, MoveTemp(Info));
+			(Test.LastMethod ? Test.LastMethod->Next : Test.FirstMethod) = this;
+			Test.LastMethod = this;
 		}
+
+		const TCHAR* const Name;
+
+		const FTestMethodInfo Info;
+
+		FUESTMethodRegistrar* Next = nullptr;
 	};
 
+private:
+	/** Methods in declaration order, names are only turned into strings when tests are enumerated */
+	FUESTMethodRegistrar* FirstMethod = nullptr;
+
+	FUESTMethodRegistrar* LastMethod = nullptr;
+
+	[[nodiscard]] const FTestMethodInfo* FindTestMethod(const FString& InTestName) const;
+
 public:
+	virtual ~FUESTTestBase() override;
+
+	/** All UEST tests that are currently registered in automation framework */
+	static const TArray<FUESTTestBase*>& GetRegisteredTests();
+
+	/** Names of TEST_METHODs, empty for simple tests */
+	[[nodiscard]] TArray<FString> GetTestMethodNames() const;
+
+	/** Whether test was declared with TEST_CLASS or BENCHMARK_CLASS */
+	[[nodiscard]] bool IsComplexTest() const
+	{
+		return bComplexTask;
+	}
+
 	virtual uint32 GetRequiredDeviceNum() const override;
 
+	using Super::GetTestSourceFileName;
+	using Super::GetTestSourceFileLine;
+
 	virtual FString GetTestSourceFileName(const FString& InTestName) const override;
 
 	virtual int32 GetTestSourceFileLine(const FString& InTestName) const override;
@@ -573,7 +971,9 @@ struct TUESTInstantiator final : FNoncopyable
 		} \
 		virtual UEST_GET_TEST_FLAGS_RETURN_TYPE GetTestFlags() const override \
 		{ \
-			return EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter | Flags; \
+			/* Tests without explicit filter, e.g. PerfFilter of benchmarks, are product tests */ \
+			constexpr auto TestFlags = Flags; \
+			return EAutomationTestFlags_ApplicationContextMask | TestFlags | ((TestFlags & EAutomationTestFlags_FilterMask) == EAutomationTestFlags::None ? EAutomationTestFlags::ProductFilter : EAutomationTestFlags::None); \
 		} \
 		using Super::GetTestSourceFileName; \
 		using Super::GetTestSourceFileLine; \
@@ -649,5 +1049,50 @@ struct TUESTInstantiator final : FNoncopyable
 	FUESTMethodRegistrar reg##MethodName{*this, TEXT(#MethodName), {[this] { MethodName(); }, TEXT(__FILE__), __LINE__}}; \
 	void MethodName()
 
+#define BENCHMARK_WITH_BASE(BaseClass, Flags, ...) \
+	TEST_CLASS_WITH_BASE(BaseClass, false, Flags, __VA_ARGS__) \
+	{ \
+		void DoBenchmark(FUESTBenchmark& Benchmark); \
+	protected: \
+		virtual bool RunTest(const FString& Parameters) override \
+		{ \
+			FUESTBenchmark::Run(*this, GetBeautifiedTestName(), [this](FUESTBenchmark& Benchmark) { DoBenchmark(Benchmark); }); \
+			return true; \
+		} \
+		/* clang-format off */ \
+	}; \
+	/* clang-format on */ \
+	void UE_JOIN(UE_JOIN(F, UEST_CLASS_NAME(__VA_ARGS__)), Impl)::DoBenchmark(FUESTBenchmark& Benchmark)
+
+/**
+ * Benchmark, registered as a test with PerfFilter.
+ * Only the body of the loop is measured, see FUESTBenchmark for settings and FUESTBenchmarkResult for produced files.
+ * Usage:
+ *
+ * BENCHMARK(MyGame, Inventory, Sort)
+ * {
+ *     // Setup goes here
+ *     for (auto _ : Benchmark)
+ *     {
+ *         Inventory.Sort();
+ *         FUESTBenchmark::DoNotOptimize(Inventory);
+ *     }
+ * }
+ */
+#define BENCHMARK(...) BENCHMARK_WITH_BASE(FUESTTestBase, EAutomationTestFlags::PerfFilter, __VA_ARGS__)
+
+#define BENCHMARK_DISABLED(...) BENCHMARK_WITH_BASE(FUESTTestBase, (EAutomationTestFlags::PerfFilter | EAutomationTestFlags::Disabled), __VA_ARGS__)
+
+/**
+ * Declares a class of benchmarks, each BENCHMARK_METHOD is reported and compared with baseline separately.
+ * BEFORE_EACH and AFTER_EACH run outside of measurement.
+ */
+#define BENCHMARK_CLASS(...) TEST_CLASS_WITH_BASE(FUESTTestBase, true, EAutomationTestFlags::PerfFilter, __VA_ARGS__)
+#define BENCHMARK_CLASS_DISABLED(...) TEST_CLASS_WITH_BASE(FUESTTestBase, true, (EAutomationTestFlags::PerfFilter | EAutomationTestFlags::Disabled), __VA_ARGS__)
+
+#define BENCHMARK_METHOD(MethodName) \
+	FUESTMethodRegistrar reg##MethodName{*this, TEXT(#MethodName), {[this] { FUESTBenchmark::Run(*this, GetBeautifiedTestName() + TEXT(".") + TEXT(#MethodName), [this](FUESTBenchmark& Benchmark) { MethodName(Benchmark); }); }, TEXT(__FILE__), __LINE__}}; \
+	void MethodName(FUESTBenchmark& Benchmark)
+
 #define BEFORE_EACH() virtual void Setup() override
 #define AFTER_EACH() virtual void TearDown() override
@@ -0,0 +1,221 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FAutomationTestBase;
+
+/**
+ * Statistics of a single benchmark, all times are per iteration.
+ *
+ * Every run is written to <ProjectSavedDir>/UEST/Benchmarks/Results/<Name>.json and compared with <ProjectSavedDir>/UEST/Benchmarks/Baseline/<Name>.json.
+ * Directories can be changed with UEST.Benchmark.ResultsDir and UEST.Benchmark.BaselineDir console variables.
+ *
+ * Format:
+ * {
+ *   "Version": 1,
+ *   "Name": "MyGame.Inventory.Sort",
+ *   "IterationsPerSample": 4096,
+ *   "Samples": 30,
+ *   "MinSeconds": 0.0000012, "MedianSeconds": 0.0000013, "P95Seconds": 0.0000015, "MeanSeconds": 0.0000013, "StdDevSeconds": 0.0000001,
+ *   "AllocationsPerIteration": 2, "AllocatedBytesPerIteration": 128
+ * }
+ * Allocation fields are only present when allocations were counted.
+ */
+struct UEST_API FUESTBenchmarkResult
+{
+	static constexpr int32 Version = 1;
+
+	FString Name;
+
+	int64 IterationsPerSample = 0;
+
+	int32 NumSamples = 0;
+
+	double MinSeconds = 0;
+
+	double MedianSeconds = 0;
+
+	double P95Seconds = 0;
+
+	double MeanSeconds = 0;
+
+	double StdDevSeconds = 0;
+
+	/** Negative when allocations were not counted */
+	double AllocationsPerIteration = -1;
+
+	double AllocatedBytesPerIteration = -1;
+
+	[[nodiscard]] bool HasAllocations() const
+	{
+		return AllocationsPerIteration >= 0;
+	}
+
+	/** Computes statistics from seconds per iteration of every sample */
+	[[nodiscard]] static FUESTBenchmarkResult FromSamples(const FString& Name, TArray<double> SampleSeconds, int64 IterationsPerSample);
+
+	[[nodiscard]] FString ToJson() const;
+
+	[[nodiscard]] static TOptional<FUESTBenchmarkResult> FromJson(const FString& Json);
+
+	/** Human-readable statistics, e.g. "median 1.3 us, min 1.2 us, p95 1.5 us, stddev 0.1 us over 30 samples of 4096 iterations" */
+	[[nodiscard]] FString GetSummary() const;
+
+	[[nodiscard]] static FString GetResultPath(const FString& Name);
+
+	[[nodiscard]] static FString GetBaselinePath(const FString& Name);
+};
+
+static FString ToString(const FUESTBenchmarkResult& Value)
+{
+	return Value.GetSummary();
+}
+
+/**
+ * Measures the body of a range-based for loop, see BENCHMARK:
+ *
+ * for (auto _ : Benchmark)
+ * {
+ *     // Measured code
+ * }
+ *
+ * Loop first runs warmup iterations for UEST.Benchmark.WarmupSeconds, which also estimate duration of one iteration.
+ * Then it runs UEST.Benchmark.Samples samples, each with the same number of iterations, picked so that all samples take UEST.Benchmark.TargetSeconds.
+ */
+class UEST_API FUESTBenchmark final : FNoncopyable
+{
+public:
+#if defined(__clang__) || defined(__GNUC__)
+	/** Loop variable carries no value, attribute keeps compilers from warning that it is unused */
+	struct __attribute__((unused)) FValue final
+	{
+	};
+#else
+	struct FValue final
+	{
+	};
+#endif
+
+	struct FSentinel final
+	{
+	};
+
+	class FIterator final
+	{
+		FUESTBenchmark& Benchmark;
+
+	public:
+		explicit FIterator(FUESTBenchmark& Benchmark)
+		    : Benchmark{Benchmark}
+		{
+		}
+
+		FValue operator*() const
+		{
+			return {};
+		}
+
+		FIterator& operator++()
+		{
+			return *this;
+		}
+
+		bool operator!=(FSentinel) const
+		{
+			return Benchmark.Next();
+		}
+	};
+
+	[[nodiscard]] FIterator begin()
+	{
+		return FIterator{*this};
+	}
+
+	[[nodiscard]] FSentinel end() const
+	{
+		return {};
+	}
+
+	/** Fraction by which median time or allocations may exceed baseline, e.g. 0.1 for 10%. Defaults to UEST.Benchmark.RegressionThreshold */
+	void SetRegressionThreshold(double Threshold);
+
+	/** Counts allocations and bytes allocated on benchmark thread while sampling. Defaults to UEST.Benchmark.CountAllocations */
+	void SetCountAllocations(bool bCount);
+
+	/** Defaults to UEST.Benchmark.Samples */
+	void SetSampleCount(int32 Count);
+
+	/** Keeps compiler from optimizing away computation of Value */
+	template<typename T>
+	static FORCEINLINE void DoNotOptimize(const T& Value)
+	{
+#if defined(__clang__) || defined(__GNUC__)
+		asm volatile("" : : "r,m"(Value) : "memory");
+#else
+		Escape(&Value);
+#endif
+	}
+
+	/** Runs benchmark body, writes its result and compares it with baseline, problems are reported as errors of Test */
+	static void Run(FAutomationTestBase& Test, const FString& Name, TFunctionRef<void(FUESTBenchmark&)> Body);
+
+	~FUESTBenchmark();
+
+private:
+	enum class EPhase : uint8
+	{
+		NotStarted,
+		Warmup,
+		Sampling,
+		Done,
+	};
+
+	EPhase Phase = EPhase::NotStarted;
+
+	int64 RemainingInBatch = 0;
+
+	int64 BatchSize = 0;
+
+	uint64 BatchStartCycles = 0;
+
+	double WarmupSeconds;
+
+	double TargetSeconds;
+
+	int32 NumSamples;
+
+	double RegressionThreshold;
+
+	bool bCountAllocations;
+
+	double ElapsedWarmupSeconds = 0;
+
+	/** Seconds per iteration */
+	TArray<double> Samples;
+
+	int64 Allocations = 0;
+
+	int64 AllocatedBytes = 0;
+
+	FUESTBenchmark();
+
+	/** Called before every iteration, only does a decrement unless a batch of iterations has ended */
+	FORCEINLINE bool Next()
+	{
+		if (RemainingInBatch > 0) [[likely]]
+		{
+			--RemainingInBatch;
+			return true;
+		}
+
+		return NextBatch();
+	}
+
+	bool NextBatch();
+
+	void StartBatch(int64 Size);
+
+	void StopCountingAllocations();
+
+	static void Escape(const volatile void* Pointer);
+};
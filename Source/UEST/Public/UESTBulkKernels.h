@@ -0,0 +1,136 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/StringBuilder.h"
+
+namespace UEST::Bulk
+{
+	/** How many failed elements are reported by bulk matchers, the rest is only counted */
+	constexpr int32 MaxReportedMismatches = 8;
+
+	/** Elements of array that failed a bulk check */
+	struct FMismatches final
+	{
+		/** Total number of failed elements */
+		int32 Num = 0;
+
+		/** Indices of first failed elements in ascending order */
+		TArray<int32, TInlineAllocator<MaxReportedMismatches>> FirstIndices;
+
+		/** Several components of a single vector may fail, it is still counted once */
+		void Add(const int32 Index)
+		{
+			if (Index == LastIndex)
+			{
+				return;
+			}
+
+			LastIndex = Index;
+			++Num;
+			if (FirstIndices.Num() < MaxReportedMismatches)
+			{
+				FirstIndices.Add(Index);
+			}
+		}
+
+		void Reset()
+		{
+			Num = 0;
+			FirstIndices.Reset();
+			LastIndex = INDEX_NONE;
+		}
+
+	private:
+		int32 LastIndex = INDEX_NONE;
+	};
+
+	/**
+	 * Kernels below compare flat arrays of components four at a time using vector registers.
+	 * Stride is the number of components of a single element, so failed component index divided by it is reported, e.g. 3 for vectors.
+	 */
+
+	/** Finds elements where |Values - Expected| > Tolerance or either is NaN, arrays must be of the same size */
+	UEST_API void FindNotNearlyEqual(TConstArrayView<float> Values, TConstArrayView<float> Expected, float Tolerance, int32 Stride, FMismatches& Out);
+	UEST_API void FindNotNearlyEqual(TConstArrayView<double> Values, TConstArrayView<double> Expected, double Tolerance, int32 Stride, FMismatches& Out);
+
+	/** Finds elements outside of [From, To] or NaN */
+	UEST_API void FindNotInRange(TConstArrayView<float> Values, float From, float To, int32 Stride, FMismatches& Out);
+	UEST_API void FindNotInRange(TConstArrayView<double> Values, double From, double To, int32 Stride, FMismatches& Out);
+
+	/** Finds infinite or NaN elements */
+	UEST_API void FindNotFinite(TConstArrayView<float> Values, int32 Stride, FMismatches& Out);
+	UEST_API void FindNotFinite(TConstArrayView<double> Values, int32 Stride, FMismatches& Out);
+
+	template<typename T>
+	constexpr int32 ComponentsOf = 1;
+
+	template<typename T>
+	constexpr int32 ComponentsOf<UE::Math::TVector<T>> = 3;
+
+	template<typename T>
+	constexpr int32 ComponentsOf<UE::Math::TRotator<T>> = 3;
+
+	template<typename T>
+	struct TComponentOf
+	{
+		using Type = T;
+	};
+
+	template<typename T>
+	struct TComponentOf<UE::Math::TVector<T>>
+	{
+		using Type = T;
+	};
+
+	template<typename T>
+	struct TComponentOf<UE::Math::TRotator<T>>
+	{
+		using Type = T;
+	};
+
+	template<typename T>
+	constexpr bool IsRotator = false;
+
+	template<typename T>
+	constexpr bool IsRotator<UE::Math::TRotator<T>> = true;
+
+	/** Any array or array view as view of its elements */
+	template<typename A>
+	TConstArrayView<std::remove_const_t<typename A::ElementType>> ViewOf(const A& Values)
+	{
+		return {Values.GetData(), static_cast<int32>(Values.Num())};
+	}
+
+	/** Views vectors and rotators as arrays of their components, so kernels do not need to know about them */
+	template<typename T>
+	TConstArrayView<typename TComponentOf<T>::Type> Flatten(const TConstArrayView<T> Values)
+	{
+		using FComponent = typename TComponentOf<T>::Type;
+		static_assert(sizeof(T) == sizeof(FComponent) * ComponentsOf<T>, "Element must consist of tightly packed components");
+
+		return {reinterpret_cast<const FComponent*>(Values.GetData()), Values.Num() * ComponentsOf<T>};
+	}
+
+	/** Lists first failed elements in matcher description, AppendElement(Index) is only called for those */
+	template<typename F>
+	void DescribeMismatches(FStringBuilderBase& Out, const FMismatches& Mismatches, const F& AppendElement)
+	{
+		if (Mismatches.Num == 0)
+		{
+			return;
+		}
+
+		Out.Appendf(TEXT(", but %d of them are not:"), Mismatches.Num);
+		for (const auto Index : Mismatches.FirstIndices)
+		{
+			Out.Appendf(TEXT(" [%d] "), Index);
+			AppendElement(Index);
+			Out << TEXT(';');
+		}
+
+		if (Mismatches.Num > Mismatches.FirstIndices.Num())
+		{
+			Out << TEXT(" ...");
+		}
+	}
+} // namespace UEST::Bulk
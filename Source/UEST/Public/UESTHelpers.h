@@ -6,7 +6,7 @@ static TEnableIf<TIsEnumClass<T>::Value, FString>::Type ToString(T Value)
 	return StaticEnum<T>()->GetNameStringByValue(static_cast<int64>(Value));
 }
 
-static FString ToString(FString Value)
+static FString ToString(const FString& Value)
 {
 	return Value;
 }
@@ -56,6 +56,16 @@ static FString ToString(const FRotator& Value)
 	return Value.ToString();
 }
 
+static FString ToString(const FVector3f& Value)
+{
+	return Value.ToString();
+}
+
+static FString ToString(const FRotator3f& Value)
+{
+	return Value.ToString();
+}
+
 template<typename T>
 static FString ToString(const T* Value)
 {
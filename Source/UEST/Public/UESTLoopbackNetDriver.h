@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Containers/Queue.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "UESTLoopbackNetDriver.generated.h"
+
+/**
+ * Net driver that passes packets between drivers of the same process through in-memory queues instead of sockets.
+ * Drivers are addressed by fake 127.0.0.1:<port> addresses, so URLs look the same as with UIpNetDriver.
+ * See FScopedGame::WithInMemoryNetworking.
+ */
+UCLASS(Transient)
+class UEST_API UUESTLoopbackNetDriver : public UNetDriver
+{
+	GENERATED_BODY()
+
+	struct FPacket final
+	{
+		TSharedPtr<const FInternetAddr> From;
+		TArray<uint8> Data;
+
+		/** Elapsed time of receiving driver when packet is due */
+		double DeliverTime = 0;
+	};
+
+	TQueue<FPacket, EQueueMode::Mpsc> Inbox;
+
+	TSharedPtr<FInternetAddr> LocalAddr;
+
+	void ReceivePacket(FPacket& Packet);
+
+	UNetConnection* ProcessConnectionlessPacket(FReceivedPacketView& PacketView);
+
+public:
+	/** Puts packet into inbox of the driver listening on Address. Returns false if there is no such driver */
+	static bool SendTo(const FInternetAddr& Address, const TSharedRef<const FInternetAddr>& From, const void* Data, int32 CountBits);
+
+	/**
+	 * Delays every packet by LagSeconds and drops LossRatio (0 to 1) of them, using RandomSeed so the same packets are lost on every run.
+	 * Lag is measured in elapsed time of receiving driver, which advances by world delta time, so it is simulated time
+	 * unlike PktLag and PktLoss of UNetDriver that rely on FPlatformTime. Applies to all loopback drivers.
+	 */
+	static void SetNetworkEmulation(float LagSeconds, float LossRatio, int32 RandomSeed = 0);
+
+	[[nodiscard]] TSharedPtr<const FInternetAddr> GetLocalAddr() const
+	{
+		return LocalAddr;
+	}
+
+	virtual bool IsAvailable() const override;
+
+	virtual bool InitConnectionClass() override;
+
+	virtual bool InitBase(bool bInitAsClient, FNetworkNotify* InNotify, const FURL& URL, bool bReuseAddressAndPort, FString& Error) override;
+
+	virtual bool InitConnect(FNetworkNotify* InNotify, const FURL& ConnectURL, FString& Error) override;
+
+	virtual bool InitListen(FNetworkNotify* InNotify, FURL& LocalURL, bool bReuseAddressAndPort, FString& Error) override;
+
+	virtual void TickDispatch(float DeltaTime) override;
+
+	virtual void LowLevelSend(TSharedPtr<const FInternetAddr> Address, void* Data, int32 CountBits, FOutPacketTraits& Traits) override;
+
+	virtual FString LowLevelGetNetworkNumber() override;
+
+	virtual void LowLevelDestroy() override;
+
+	virtual bool IsNetResourceValid() override;
+
+	virtual ISocketSubsystem* GetSocketSubsystem() override;
+};
+
+UCLASS(Transient)
+class UEST_API UUESTLoopbackConnection : public UNetConnection
+{
+	GENERATED_BODY()
+
+public:
+	virtual void InitLocalConnection(UNetDriver* InDriver, FSocket* InSocket, const FURL& InURL, EConnectionState InState, int32 InMaxPacket = 0, int32 InPacketOverhead = 0) override;
+
+	virtual void InitRemoteConnection(UNetDriver* InDriver, FSocket* InSocket, const FURL& InURL, const FInternetAddr& InRemoteAddr, EConnectionState InState, int32 InMaxPacket = 0, int32 InPacketOverhead = 0) override;
+
+	virtual void LowLevelSend(void* Data, int32 CountBits, FOutPacketTraits& Traits) override;
+
+	virtual FString LowLevelGetRemoteAddress(bool bAppendPort = false) override;
+
+	virtual FString LowLevelDescribe() override;
+};
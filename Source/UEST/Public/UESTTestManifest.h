@@ -0,0 +1,32 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Machine-readable list of all UEST tests, so IDEs and CI can discover tests without booting the engine.
+ *
+ * Manifest is written to GetDefaultPath() after engine init when automation modules are loaded, if its content changed.
+ * It can also be written explicitly with: UnrealEditor-Cmd <Project> -run=UESTTestRunner -Manifest[=Path]
+ *
+ * Format:
+ * {
+ *   "Version": 1,
+ *   "Tests": [
+ *     {"Name": "UEST.SimpleTest", "Disabled": false, "Complex": false, "File": "...", "Line": 5, "Methods": []},
+ *     {"Name": "UEST.SimpleTestClass", "Disabled": false, "Complex": true, "File": "...", "Line": 72, "Methods": [{"Name": "Test1", "File": "...", "Line": 74}]}
+ *   ]
+ * }
+ */
+struct UEST_API FUESTTestManifest
+{
+	static constexpr int32 Version = 1;
+
+	/** <ProjectSavedDir>/UEST/TestManifest.json */
+	[[nodiscard]] static FString GetDefaultPath();
+
+	/** Serializes all tests of currently loaded modules */
+	[[nodiscard]] static FString Generate();
+
+	/** Writes manifest to Path, unless file already has exactly the same content */
+	static bool Write(const FString& Path = GetDefaultPath());
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FJsonObject;
+
+struct FUESTQueuedTest final
+{
+	/** Name that FAutomationTestFramework::StartTestByName understands */
+	FString FullName;
+	FString DisplayName;
+	FString SourceFile;
+	int32 SourceLine = 0;
+};
+
+enum class EUESTTestClaimResult : uint8
+{
+	Claimed,
+
+	/** All tests were claimed */
+	QueueEmpty,
+
+	/** Queued tests could not be claimed, for example because queue directory is not writable */
+	Failed,
+};
+
+/**
+ * File-based queue that UESTTestRunner worker processes claim tests from, see UUESTTestRunnerCommandlet.
+ * Every test is a file named by its index that moves from Queue to Claimed directory when a worker takes it.
+ * Its result is then written to Results directory under the same name.
+ */
+class UEST_API FUESTTestQueue final
+{
+	FString RunDir;
+
+	[[nodiscard]] FString GetPath(const TCHAR* DirName, int32 Index) const;
+
+public:
+	[[nodiscard]] explicit FUESTTestQueue(FString RunDir);
+
+	[[nodiscard]] const FString& GetRunDir() const
+	{
+		return RunDir;
+	}
+
+	/** Number of worker processes that makes sense for NumTests */
+	[[nodiscard]] static int32 GetNumShards(int32 RequestedShards, int32 NumTests);
+
+	/** Creates queue directories and queues Tests, so workers claim them in this order */
+	bool Enqueue(TConstArrayView<FUESTQueuedTest> Tests) const;
+
+	/**
+	 * Takes the next queued test. Safe to call from several processes at once, every test is claimed only once.
+	 * Gives up with Failed after MaxClaimAttempts rounds in which tests were queued but none could be claimed.
+	 */
+	[[nodiscard]] EUESTTestClaimResult Claim(int32& OutIndex, FString& OutFullName) const;
+
+	static constexpr int32 MaxClaimAttempts = 5;
+
+	void SetResult(int32 Index, const TSharedRef<FJsonObject>& Result) const;
+
+	/** Result written by worker, or a failed result that explains why there is none */
+	[[nodiscard]] TSharedRef<FJsonObject> GetResult(int32 Index) const;
+
+	/** Merges results of all queued tests into a single report */
+	[[nodiscard]] TSharedRef<FJsonObject> MakeReport(TConstArrayView<FUESTQueuedTest> Tests, int32 NumShards, double DurationSeconds) const;
+};
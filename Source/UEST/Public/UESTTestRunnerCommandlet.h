@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "UESTTestRunnerCommandlet.generated.h"
+
+/**
+ * Runs UEST tests in multiple local engine processes and merges their results into a single JSON report.
+ *
+ * Tests are put into a file-based queue and every worker process claims the next test as soon as it finishes the previous one,
+ * so slow tests do not hold up other workers.
+ *
+ * Usage: UnrealEditor-Cmd <Project> -run=UESTTestRunner [-Shards=N] [-Filter=TestNamePrefix] [-Report=Path] [-Timeout=Seconds]
+ * With -Manifest[=Path], only writes test manifest and exits, see FUESTTestManifest.
+ */
+UCLASS()
+class UEST_API UUESTTestRunnerCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+	int32 RunCoordinator(const FString& Params);
+
+	int32 RunWorker(const FString& RunDir, int32 WorkerIndex);
+
+public:
+	UUESTTestRunnerCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
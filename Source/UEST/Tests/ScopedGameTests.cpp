@@ -1,7 +1,17 @@
+#include "Algo/AllOf.h"
+#include "Engine/LevelStreamingDynamic.h"
+#include "GameFramework/DefaultPawn.h"
 #include "GameFramework/GameModeBase.h"
 #include "GameFramework/GameSession.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/Info.h"
+#include "GameFramework/PlayerState.h"
+#include "GameFramework/WorldSettings.h"
+#include "Misc/ScopeExit.h"
 #include "ScopedGame.h"
+#include "ScopedGameTickProfile.h"
 #include "UESTHelpers.h"
+#include "UESTLoopbackNetDriver.h"
 // UEST.h needs to be after UESTHelpers.h
 #include "UEST.h"
 
@@ -19,7 +29,7 @@ TEST(UEST, ScopedGame, Simple)
 	ASSERT_THAT(Client, Is::Not::Null);
 
 	// Actually, you can connect as many clients as you want!
-	// Well, almost. Max number of simultaneous game instances is 10, see MAX_PIE_INSTANCES in UE sources.
+	// Well, almost. Server only accepts MaxPlayers connections.
 	for (int32 Index = 0; Index < FMath::Min(4, Server->GetWorld()->GetAuthGameMode()->GameSession->MaxPlayers - 1); ++Index)
 	{
 		Tester.CreateClientFor(*Server);
@@ -78,3 +88,579 @@ TEST(UEST, ScopedGame, CheckNetMode)
 	const auto StandaloneNetMode = StandaloneWorld->GetNetMode();
 	ASSERT_THAT(StandaloneNetMode, Is::EqualTo<ENetMode>(NM_Standalone));
 }
+
+TEST(UEST, ScopedGame, MapTemplateCache)
+{
+	ON_SCOPE_EXIT
+	{
+		FScopedGameInstance::ClearMapTemplateCache();
+	};
+
+	{
+		// First game loads map from disk and keeps it as a template
+		auto Tester = FScopedGame().WithMapTemplateCache().Create();
+		ASSERT_THAT(Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry")), Is::Not::Null);
+	}
+
+	int32 NumMapLoads = 0;
+	const auto Handle = FCoreUObjectDelegates::OnEndLoadPackage.AddLambda([&NumMapLoads](const FEndLoadPackageContext& Context)
+	{
+		for (const auto* Package : Context.LoadedPackages)
+		{
+			if (Package && Package->GetFName() == TEXT("/Engine/Maps/Entry"))
+			{
+				++NumMapLoads;
+			}
+		}
+	});
+	ON_SCOPE_EXIT
+	{
+		FCoreUObjectDelegates::OnEndLoadPackage.Remove(Handle);
+	};
+
+	auto Tester = FScopedGame().WithMapTemplateCache().Create();
+
+	UGameInstance* Server = Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Server, Is::Not::Null);
+
+	// Client travels to the same map, so it is duplicated from the template too
+	UGameInstance* Client = Tester.CreateClientFor(*Server);
+	ASSERT_THAT(Client, Is::Not::Null);
+
+	UGameInstance* Standalone = Tester.CreateGame(EScopedGameType::Client, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Standalone, Is::Not::Null);
+	ASSERT_THAT(Standalone->GetWorld(), Is::Not::EqualTo<UWorld*>(Server->GetWorld()));
+
+	// None of the games loaded map package again
+	ASSERT_THAT(NumMapLoads, Is::EqualTo<int32>(0));
+}
+
+TEST(UEST, ScopedGame, Pooling)
+{
+	ON_SCOPE_EXIT
+	{
+		FScopedGameInstance::DrainGamePool();
+	};
+
+	UGameInstance* FirstServer;
+	{
+		auto Tester = FScopedGame().WithPooling().Create();
+		FirstServer = Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry"));
+		ASSERT_THAT(FirstServer, Is::Not::Null);
+	}
+
+	auto Tester = FScopedGame().WithPooling().Create();
+
+	// Game instance is taken from pool instead of being created from scratch
+	UGameInstance* Server = Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Server, Is::EqualTo<UGameInstance*>(FirstServer));
+	ASSERT_THAT(Server->GetWorld()->GetNetMode(), Is::EqualTo<ENetMode>(NM_DedicatedServer));
+
+	UGameInstance* Client = Tester.CreateClientFor(*Server);
+	ASSERT_THAT(Client, Is::Not::Null);
+}
+
+TEST(UEST, ScopedGame, DeferredGarbageCollection)
+{
+	// Default policy collects garbage right away, so scope interval is counted from here
+	{
+		auto Tester = FScopedGame().Create();
+		ASSERT_THAT(Tester.DestroyGame(Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry"))));
+	}
+
+	FScopedGameGCPolicy GCPolicy;
+	GCPolicy.Timing = EScopedGameGCTiming::ScopeEnd;
+	GCPolicy.ScopeInterval = 2;
+
+	TWeakObjectPtr<UWorld> DestroyedWorld;
+	{
+		auto Tester = FScopedGame().WithGarbageCollectionPolicy(GCPolicy).Create();
+
+		UGameInstance* Server = Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry"));
+		ASSERT_THAT(Server, Is::Not::Null);
+
+		// Destroyed clients are not collected immediately, new clients get different PIE instances
+		for (int32 Index = 0; Index < 3; ++Index)
+		{
+			UGameInstance* Client = Tester.CreateClientFor(*Server);
+			ASSERT_THAT(Client, Is::Not::Null);
+
+			if (!DestroyedWorld.IsValid(true))
+			{
+				DestroyedWorld = Client->GetWorld();
+			}
+
+			ASSERT_THAT(Tester.DestroyGame(Client));
+		}
+
+		ASSERT_THAT(DestroyedWorld.IsValid(true));
+	}
+
+	// First scope of the interval does not collect garbage
+	ASSERT_THAT(DestroyedWorld.IsValid(true));
+
+	{
+		auto Tester = FScopedGame().WithGarbageCollectionPolicy(GCPolicy).Create();
+		ASSERT_THAT(Tester.DestroyGame(Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry"))));
+		ASSERT_THAT(DestroyedWorld.IsValid(true));
+	}
+
+	// Second one does
+	ASSERT_THAT(DestroyedWorld.IsValid(true), Is::False);
+}
+
+TEST(UEST, ScopedGame, UnloadedStreamingLevelIsCollected)
+{
+	TWeakObjectPtr<UPackage> LevelPackage;
+	{
+		auto Tester = FScopedGame().Create();
+
+		UGameInstance* Server = Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry"));
+		ASSERT_THAT(Server, Is::Not::Null);
+
+		bool bSuccess = false;
+		auto* StreamingLevel = ULevelStreamingDynamic::LoadLevelInstance(Server->GetWorld(), TEXT("/Engine/Maps/Entry"), FVector::ZeroVector, FRotator::ZeroRotator, bSuccess);
+		ASSERT_THAT(bSuccess);
+		ASSERT_THAT(Tester.TickUntilStreamingComplete());
+		ASSERT_THAT(StreamingLevel->GetLoadedLevel(), Is::Not::Null);
+
+		LevelPackage = StreamingLevel->GetLoadedLevel()->GetOutermost();
+
+		// Level is gone from world by the time game is destroyed
+		StreamingLevel->SetIsRequestingUnloadAndRemoval(true);
+		ASSERT_THAT(Tester.TickUntil([&] { return !Server->GetWorld()->GetStreamingLevels().Contains(StreamingLevel); }));
+		ASSERT_THAT(LevelPackage.IsValid(true));
+	}
+
+	ASSERT_THAT(LevelPackage.IsValid(true), Is::False);
+}
+
+TEST(UEST, ScopedGame, CreateClientsFor)
+{
+	auto Tester = FScopedGame().Create();
+
+	UGameInstance* Server = Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Server, Is::Not::Null);
+
+	TArray<EScopedGameConnectError> Errors;
+	const auto Clients = Tester.CreateClientsFor(*Server, 4, &Errors);
+	ASSERT_THAT(Clients.Num(), Is::EqualTo<int32>(4));
+	ASSERT_THAT(Errors.Num(), Is::EqualTo<int32>(4));
+
+	for (int32 Index = 0; Index < Clients.Num(); ++Index)
+	{
+		ASSERT_THAT(Clients[Index], Is::Not::Null);
+		ASSERT_THAT(Errors[Index], Is::EqualTo<EScopedGameConnectError>(EScopedGameConnectError::Success));
+		ASSERT_THAT(Clients[Index]->GetWorld()->GetFirstPlayerController(), Is::Not::Null);
+	}
+}
+
+TEST(UEST, ScopedGame, MoreThanMaxPIEInstances)
+{
+	auto Tester = FScopedGame().Create();
+
+	UGameInstance* Server = Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Server, Is::Not::Null);
+
+	// MAX_PIE_INSTANCES is 10, but UEST is only limited by memory. Every game above the limit is reported
+	constexpr int32 NumClients = 32;
+	AddExpectedError(TEXT("is above engine limit"), EAutomationExpectedErrorFlags::Contains, 0);
+	Server->GetWorld()->GetAuthGameMode()->GameSession->MaxPlayers = NumClients;
+
+	TArray<EScopedGameConnectError> Errors;
+	const auto Clients = Tester.CreateClientsFor(*Server, NumClients, &Errors, EScopedGameType::HeadlessClient);
+
+	TSet<int32> PIEInstances{Server->GetWorldContext()->PIEInstance};
+	for (int32 Index = 0; Index < NumClients; ++Index)
+	{
+		ASSERT_THAT(Clients[Index], Is::Not::Null);
+		ASSERT_THAT(Errors[Index], Is::EqualTo<EScopedGameConnectError>(EScopedGameConnectError::Success));
+		PIEInstances.Add(Clients[Index]->GetWorldContext()->PIEInstance);
+	}
+
+	ASSERT_THAT(PIEInstances.Num(), Is::EqualTo<int32>(NumClients + 1));
+
+	// All clients keep ticking and replicating at once
+	TArray<double> TimesBefore;
+	for (const auto* Client : Clients)
+	{
+		TimesBefore.Add(Client->GetWorld()->GetTimeSeconds());
+	}
+
+	auto* ServerActor = Server->GetWorld()->SpawnActor<AInfo>();
+	ServerActor->SetReplicates(true);
+	ServerActor->bAlwaysRelevant = true;
+	ASSERT_THAT(Tester.TickUntil([&] { return Algo::AllOf(Clients, [&](const UGameInstance* Client) { return Tester.FindReplicatedObjectIn(ServerActor, Client->GetWorld()) != nullptr; }); }));
+
+	for (int32 Index = 0; Index < NumClients; ++Index)
+	{
+		ASSERT_THAT(Clients[Index]->GetWorld()->GetTimeSeconds(), Is::GreaterThan<double>(TimesBefore[Index]));
+	}
+}
+
+TEST(UEST, ScopedGame, VirtualTime)
+{
+	const double AppTimeBeforeScope = FApp::GetCurrentTime();
+	const double AppDeltaTimeBeforeScope = FApp::GetDeltaTime();
+	{
+		auto Tester = FScopedGame().WithVirtualTime().Create();
+
+		UGameInstance* Standalone = Tester.CreateGame(EScopedGameType::Client, TEXT("/Engine/Maps/Entry"));
+		ASSERT_THAT(Standalone, Is::Not::Null);
+
+		const double AppTimeBefore = FApp::GetCurrentTime();
+		const double RealTimeBefore = FPlatformTime::Seconds();
+
+		Tester.Tick(60, 1);
+
+		ASSERT_THAT(FApp::GetCurrentTime() - AppTimeBefore, Is::NearlyEqualTo<double, double>(60, 1.1));
+		ASSERT_THAT(FPlatformTime::Seconds() - RealTimeBefore, Is::LessThan<double>(60));
+	}
+
+	// Engine clock is back where it was
+	ASSERT_THAT(FApp::GetCurrentTime(), Is::EqualTo<double>(AppTimeBeforeScope));
+	ASSERT_THAT(FApp::GetDeltaTime(), Is::EqualTo<double>(AppDeltaTimeBeforeScope));
+}
+
+TEST(UEST, ScopedGame, SelectiveTick)
+{
+	auto Tester = FScopedGame().Create();
+
+	UGameInstance* Fast = Tester.CreateGame(EScopedGameType::Client, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Fast, Is::Not::Null);
+	UGameInstance* Slow = Tester.CreateGame(EScopedGameType::Client, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Slow, Is::Not::Null);
+	UGameInstance* Frozen = Tester.CreateGame(EScopedGameType::Client, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Frozen, Is::Not::Null);
+
+	Tester.SetTickInterval(*Slow, 0.5f);
+	Tester.SetFrozen(*Frozen, true);
+
+	const double FrozenTimeBefore = Frozen->GetWorld()->GetTimeSeconds();
+	Tester.Tick(1);
+
+	// Slow game gets accumulated time in larger steps, frozen game does not advance at all
+	ASSERT_THAT(Slow->GetWorld()->GetTimeSeconds(), Is::NearlyEqualTo<double, double>(Fast->GetWorld()->GetTimeSeconds(), 0.01));
+	ASSERT_THAT(Frozen->GetWorld()->GetTimeSeconds(), Is::NearlyEqualTo<double, double>(FrozenTimeBefore, 0.01));
+
+	const double SlowTimeBefore = Slow->GetWorld()->GetTimeSeconds();
+	Tester.TickOnly({Fast}, 1);
+	ASSERT_THAT(Slow->GetWorld()->GetTimeSeconds(), Is::NearlyEqualTo<double, double>(SlowTimeBefore, 0.01));
+}
+
+TEST(UEST, ScopedGame, TickProfiler)
+{
+	auto Tester = FScopedGame().WithTickProfiler().Create();
+
+	UGameInstance* Server = Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Server, Is::Not::Null);
+
+	const auto* Profile = Tester.GetTickProfile();
+	ASSERT_THAT(Profile, Is::Not::Null);
+
+	// Same float arithmetic as TickInSteps, accumulated error decides whether a final partial step is taken (10 steps for 1 s, 6 for 0.5 s)
+	const auto CountSteps = [](const float DeltaSeconds, const float StepSeconds) {
+		int32 Result = 0;
+		for (auto RemainingTickTime = DeltaSeconds; RemainingTickTime >= 0; RemainingTickTime -= StepSeconds)
+		{
+			++Result;
+		}
+		return Result;
+	};
+
+	const int32 NumFramesBefore = Profile->Frames.Num();
+	Tester.Tick(1);
+
+	ASSERT_THAT(Profile->Frames.Num() - NumFramesBefore, Is::EqualTo<int32>(CountSteps(1, FScopedGameInstance::DefaultStepSeconds)));
+	ASSERT_THAT(Profile->GetGameSeconds(*Server), Is::Positive);
+	ASSERT_THAT(Profile->GetPhaseSeconds(EScopedGameTickPhase::WorldTick), Is::Positive);
+	ASSERT_THAT(Profile->GetSlowestFrames(3).Num(), Is::EqualTo<int32>(3));
+
+	// Async loading is not budgeted in default blocking streaming mode
+	ASSERT_THAT(Algo::AllOf(Profile->Frames, [](const auto& Frame) { return Frame.AsyncLoadingSeconds == 0; }));
+
+	// Tick groups split the world tick
+	double TickGroupSeconds = 0;
+	for (int32 TickGroup = 0; TickGroup < FScopedGameFrameProfile::NumTickGroups; ++TickGroup)
+	{
+		TickGroupSeconds += Profile->GetTickGroupSeconds(static_cast<ETickingGroup>(TickGroup));
+	}
+	ASSERT_THAT(Profile->GetGameTickGroupSeconds(*Server, TG_PrePhysics), Is::Positive);
+	ASSERT_THAT(TickGroupSeconds, Is::AtMost<double>(Profile->GetPhaseSeconds(EScopedGameTickPhase::WorldTick)));
+
+	// Game that reuses PIE instance of a destroyed one is profiled separately
+	UGameInstance* Client = Tester.CreateGame(EScopedGameType::Client, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Client, Is::Not::Null);
+	const auto PIEInstance = Client->GetWorldContext()->PIEInstance;
+	Tester.Tick(1);
+	ASSERT_THAT(Tester.DestroyGame(Client));
+
+	const int32 NumFramesBeforeNewClient = Profile->Frames.Num();
+	UGameInstance* NewClient = Tester.CreateGame(EScopedGameType::Client, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(NewClient, Is::Not::Null);
+	ASSERT_THAT(NewClient->GetWorldContext()->PIEInstance, Is::EqualTo<int32>(PIEInstance));
+	Tester.Tick(0.5f);
+
+	ASSERT_THAT(Profile->GameNames.Num(), Is::EqualTo<int32>(3));
+	ASSERT_THAT(Tester.TickStats(*NewClient).FrameSeconds.Num(), Is::EqualTo<int32>(Profile->Frames.Num() - NumFramesBeforeNewClient));
+}
+
+TEST(UEST, ScopedGame, TickBudget)
+{
+	auto Tester = FScopedGame().WithTickProfiler().Create();
+
+	UGameInstance* Server = Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Server, Is::Not::Null);
+
+	Tester.Tick(1);
+
+	const auto Stats = Tester.TickStats(*Server);
+	ASSERT_THAT(Stats.FrameSeconds, Is::Not::Empty);
+
+	// Empty map is cheap to tick
+	ASSERT_THAT(Stats, Is::WithinTickBudget(FTimespan::FromSeconds(1)));
+	ASSERT_THAT(Stats, Is::Not::WithinTickBudget(FTimespan::Zero()));
+}
+
+TEST(UEST, ScopedGame, BudgetedStreaming)
+{
+	FScopedGameStreamingSettings StreamingSettings;
+	StreamingSettings.Mode = EScopedGameStreamingMode::Budgeted;
+	auto Tester = FScopedGame().WithStreamingSettings(StreamingSettings).WithTickProfiler().Create();
+
+	UGameInstance* Standalone = Tester.CreateGame(EScopedGameType::Client, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Standalone, Is::Not::Null);
+
+	bool bSuccess = false;
+	auto* StreamingLevel = ULevelStreamingDynamic::LoadLevelInstance(Standalone->GetWorld(), TEXT("/Engine/Maps/Entry"), FVector::ZeroVector, FRotator::ZeroRotator, bSuccess);
+	ASSERT_THAT(bSuccess);
+
+	const auto* Profile = Tester.GetTickProfile();
+	const int32 NumFramesBefore = Profile->Frames.Num();
+	ASSERT_THAT(Tester.TickUntilStreamingComplete());
+	ASSERT_THAT(StreamingLevel->GetLoadedLevel(), Is::Not::Null);
+	ASSERT_THAT(StreamingLevel->IsLevelVisible(), Is::True);
+
+	// Level was loaded by budgeted async loading once per frame rather than by blocking in level streaming
+	ASSERT_THAT(Profile->Frames.Num() - NumFramesBefore, Is::Positive);
+	const auto bAllFramesLoaded = Algo::AllOf(MakeArrayView(Profile->Frames).RightChop(NumFramesBefore), [](const auto& Frame) { return Frame.AsyncLoadingSeconds > 0; });
+	ASSERT_THAT(bAllFramesLoaded);
+}
+
+TEST(UEST, ScopedGame, InMemoryNetworking)
+{
+	auto Tester = FScopedGame().WithInMemoryNetworking().Create();
+
+	UGameInstance* Server = Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Server, Is::Not::Null);
+	ASSERT_THAT(Cast<UUESTLoopbackNetDriver>(Server->GetWorld()->GetNetDriver()), Is::Not::Null);
+
+	UGameInstance* Client = Tester.CreateClientFor(*Server);
+	ASSERT_THAT(Client, Is::Not::Null);
+	ASSERT_THAT(Cast<UUESTLoopbackNetDriver>(Client->GetWorld()->GetNetDriver()), Is::Not::Null);
+	ASSERT_THAT(Client->GetWorld()->GetFirstPlayerController(), Is::Not::Null);
+}
+
+TEST(UEST, ScopedGame, NetworkEmulation)
+{
+	FScopedGameNetworkEmulation NetworkEmulation;
+	NetworkEmulation.LagSeconds = 0.25f;
+	auto Tester = FScopedGame().WithInMemoryNetworking().WithNetworkEmulation(NetworkEmulation).Create();
+
+	UGameInstance* Server = Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Server, Is::Not::Null);
+
+	UGameInstance* Client = Tester.CreateClientFor(*Server);
+	ASSERT_THAT(Client, Is::Not::Null);
+
+	auto* ServerActor = Server->GetWorld()->SpawnActor<AInfo>();
+	ServerActor->SetReplicates(true);
+	ServerActor->bAlwaysRelevant = true;
+
+	// Lag is simulated time, so it does not slow the test down
+	const auto TimeBefore = Server->GetWorld()->GetTimeSeconds();
+	ASSERT_THAT(Tester.TickUntil([&] { return Tester.FindReplicatedObjectIn(ServerActor, Client->GetWorld()) != nullptr; }));
+	ASSERT_THAT(Server->GetWorld()->GetTimeSeconds() - TimeBefore, Is::AtLeast<double>(NetworkEmulation.LagSeconds));
+}
+
+TEST(UEST, ScopedGame, NetStats)
+{
+	auto Tester = FScopedGame().Create();
+
+	UGameInstance* Server = Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Server, Is::Not::Null);
+
+	UGameInstance* Client = Tester.CreateClientFor(*Server);
+	ASSERT_THAT(Client, Is::Not::Null);
+	ASSERT_THAT(Tester.NetStats(*Server).OutBytes, Is::Positive);
+
+	Tester.ResetNetStats();
+	Tester.Tick(5);
+
+	const auto Stats = Tester.NetStats(*Server, *Client);
+	ASSERT_THAT(Stats.Seconds, Is::NearlyEqualTo<double, double>(5, 0.01));
+	ASSERT_THAT(Stats.OutPackets, Is::Positive);
+	ASSERT_THAT(Stats.GetOutBytesPerSecond(), Is::AtMost<double>(4096));
+
+	// Client receives what server sent, except packets that were in flight when counting started or ended
+	ASSERT_THAT(static_cast<double>(Tester.NetStats(*Client).InBytes), Is::NearlyEqualTo<double, double>(Stats.OutBytes, Stats.OutBytes * 0.1));
+}
+
+TEST(UEST, ScopedGame, MapReplicatedObjects)
+{
+	auto Tester = FScopedGame().Create();
+
+	UGameInstance* Server = Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Server, Is::Not::Null);
+
+	UGameInstance* Client = Tester.CreateClientFor(*Server);
+	ASSERT_THAT(Client, Is::Not::Null);
+
+	const auto ObjectMap = Tester.MapReplicatedObjects(*Client->GetWorld(), *Server->GetWorld());
+	ASSERT_THAT(Tester.MapReplicatedObjects(*Client->GetWorld(), *Server->GetWorld()).Get(), Is::EqualTo<const FScopedGameObjectMap*>(ObjectMap.Get()));
+
+	APlayerController* ClientPC = Client->GetWorld()->GetFirstPlayerController();
+	APlayerController* ServerPC = ObjectMap->Find(ClientPC);
+	ASSERT_THAT(ServerPC, Is::Not::Null);
+	ASSERT_THAT(ServerPC, Is::EqualTo<APlayerController*>(Tester.FindReplicatedObjectIn(ClientPC, Server->GetWorld())));
+	ASSERT_THAT(ObjectMap->FindReverse(ServerPC), Is::EqualTo<UObject*>(ClientPC));
+
+	const auto NumMappedBefore = ObjectMap->Num();
+	auto* ServerActor = Server->GetWorld()->SpawnActor<AInfo>();
+	ServerActor->SetReplicates(true);
+	ServerActor->bAlwaysRelevant = true;
+	ASSERT_THAT(Tester.TickUntil([&] { return ObjectMap->Num() > NumMappedBefore; }), Is::True);
+
+	ServerActor->Destroy();
+	ASSERT_THAT(Tester.TickUntil([&] { return ObjectMap->Num() == NumMappedBefore; }), Is::True);
+
+	// Map is gone together with the client
+	ASSERT_THAT(Tester.DestroyGame(Client));
+	ASSERT_THAT(ObjectMap.IsValid(), Is::False);
+}
+
+TEST(UEST, ScopedGame, RejectedLoginFailsImmediately)
+{
+	auto Tester = FScopedGame().Create();
+
+	UGameInstance* Server = Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Server, Is::Not::Null);
+
+	// Server is full, so it rejects login
+	Server->GetWorld()->GetAuthGameMode()->GameSession->MaxPlayers = 0;
+
+	AddExpectedError(TEXT("Failed connecting client 0 to dedicated server"), EAutomationExpectedErrorFlags::Contains, 0);
+
+	const auto TimeBefore = Server->GetWorld()->GetTimeSeconds();
+	TArray<EScopedGameConnectError> Errors;
+	const auto Clients = Tester.CreateClientsFor(*Server, 1, &Errors);
+	ASSERT_THAT(Clients[0], Is::Null);
+	ASSERT_THAT(Errors[0], Is::EqualTo<EScopedGameConnectError>(EScopedGameConnectError::NetworkFailure));
+	ASSERT_THAT(Server->GetWorld()->GetTimeSeconds() - TimeBefore, Is::LessThan<double>(2));
+}
+
+TEST(UEST, ScopedGame, HeadlessClient)
+{
+	auto Tester = FScopedGame().Create();
+
+	UGameInstance* Server = Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Server, Is::Not::Null);
+
+	UGameInstance* Client = Tester.CreateClientFor(*Server, true, EScopedGameType::HeadlessClient);
+	ASSERT_THAT(Client, Is::Not::Null);
+	ASSERT_THAT(Client->GetGameViewportClient(), Is::Null);
+	ASSERT_THAT(Client->GetWorld()->GetNetMode(), Is::EqualTo<ENetMode>(NM_Client));
+
+	APlayerController* ClientPC = Client->GetWorld()->GetFirstPlayerController();
+	ASSERT_THAT(ClientPC, Is::Not::Null);
+	ASSERT_THAT(ClientPC->PlayerState, Is::Not::Null);
+	ASSERT_THAT(Tester.FindReplicatedObjectIn(ClientPC, Server->GetWorld()), Is::Not::Null);
+}
+
+TEST(UEST, ScopedGame, Checkpoint)
+{
+	auto Tester = FScopedGame().Create();
+
+	UGameInstance* Server = Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Server, Is::Not::Null);
+
+	auto* World = Server->GetWorld();
+	auto* Moved = World->SpawnActor<ADefaultPawn>();
+	Moved->SetActorLocation(FVector{100, 0, 0});
+	auto* Destroyed = World->SpawnActor<AInfo>();
+	const auto DestroyedName = Destroyed->GetFName();
+
+	Tester.SaveCheckpoint();
+
+	Moved->SetActorLocation(FVector{200, 0, 0});
+	Destroyed->Destroy();
+	auto* Spawned = World->SpawnActor<AInfo>();
+	auto* AddedComponent = NewObject<USceneComponent>(Moved, TEXT("AddedComponent"));
+	Moved->AddInstanceComponent(AddedComponent);
+	AddedComponent->RegisterComponent();
+
+	ASSERT_THAT(Tester.RestoreCheckpoint(), Is::True);
+	ASSERT_THAT(Moved->GetActorLocation(), Is::EqualTo<FVector>(FVector{100, 0, 0}));
+	ASSERT_THAT(Moved->GetRootComponent()->IsRegistered(), Is::True);
+	ASSERT_THAT(AddedComponent->IsBeingDestroyed(), Is::True);
+	ASSERT_THAT(Spawned->IsActorBeingDestroyed(), Is::True);
+	ASSERT_THAT(FindObjectFast<AInfo>(Moved->GetLevel(), DestroyedName), Is::Not::Null);
+}
+
+TEST(UEST, ScopedGame, CheckpointKeepsPlayersThatJoinedLater)
+{
+	auto Tester = FScopedGame().Create();
+
+	UGameInstance* Server = Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Server, Is::Not::Null);
+	UGameInstance* Client = Tester.CreateClientFor(*Server);
+	ASSERT_THAT(Client, Is::Not::Null);
+
+	Tester.SaveCheckpoint();
+
+	UGameInstance* LateClient = Tester.CreateClientFor(*Server);
+	ASSERT_THAT(LateClient, Is::Not::Null);
+
+	auto* LatePlayerState = Tester.FindReplicatedObjectIn(LateClient->GetWorld()->GetFirstPlayerController()->PlayerState.Get(), Server->GetWorld());
+	ASSERT_THAT(LatePlayerState, Is::Not::Null);
+
+	auto* GameState = Server->GetWorld()->GetGameState();
+	const auto NumPlayers = GameState->PlayerArray.Num();
+	const auto NumGameModePlayers = Server->GetWorld()->GetAuthGameMode()->GetNumPlayers();
+
+	ASSERT_THAT(Tester.RestoreCheckpoint(), Is::True);
+	ASSERT_THAT(LatePlayerState->IsActorBeingDestroyed(), Is::False);
+	ASSERT_THAT(GameState->PlayerArray.Contains(LatePlayerState));
+	ASSERT_THAT(GameState->PlayerArray.Num(), Is::EqualTo<int32>(NumPlayers));
+	ASSERT_THAT(Server->GetWorld()->GetAuthGameMode()->GetNumPlayers(), Is::EqualTo<int32>(NumGameModePlayers));
+}
+
+TEST(UEST, ScopedGame, CheckpointLevelPlacedReplicatedActor)
+{
+	auto Tester = FScopedGame().Create();
+
+	UGameInstance* Server = Tester.CreateGame(EScopedGameType::Server, TEXT("/Engine/Maps/Entry"));
+	ASSERT_THAT(Server, Is::Not::Null);
+	UGameInstance* Client = Tester.CreateClientFor(*Server);
+	ASSERT_THAT(Client, Is::Not::Null);
+
+	// World settings are placed in level and replicated
+	auto* ServerSettings = Server->GetWorld()->GetWorldSettings();
+	auto* ClientSettings = Client->GetWorld()->GetWorldSettings();
+	ASSERT_THAT(ServerSettings->IsNetStartupActor(), Is::True);
+	ASSERT_THAT(ServerSettings->GetIsReplicated(), Is::True);
+	const auto GravityZ = ServerSettings->WorldGravityZ;
+
+	Tester.SaveCheckpoint();
+
+	ServerSettings->WorldGravityZ = GravityZ + 100;
+	ServerSettings->ForceNetUpdate();
+	ASSERT_THAT(Tester.TickUntil([&] { return FMath::IsNearlyEqual(ClientSettings->WorldGravityZ, GravityZ + 100); }));
+
+	// Actor is restored in place, so it stays net startup and replicates restored value
+	ASSERT_THAT(Tester.RestoreCheckpoint(), Is::True);
+	ASSERT_THAT(Server->GetWorld()->GetWorldSettings(), Is::EqualTo<AWorldSettings*>(ServerSettings));
+	ASSERT_THAT(ServerSettings->IsNetStartupActor(), Is::True);
+	ASSERT_THAT(static_cast<double>(ServerSettings->WorldGravityZ), Is::NearlyEqualTo<double, double>(GravityZ, 0.01));
+	ASSERT_THAT(Tester.TickUntil([&] { return FMath::IsNearlyEqual(ClientSettings->WorldGravityZ, GravityZ); }));
+}
@@ -1,4 +1,12 @@
-﻿#include "UESTHelpers.h"
+﻿#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeExit.h"
+#include "Serialization/JsonSerializer.h"
+#include "UESTHelpers.h"
+#include "UESTTestManifest.h"
+#include "UESTTestQueue.h"
 // UEST.h needs to be after UESTHelpers.h
 #include "UEST.h"
 
@@ -58,11 +66,165 @@ TEST(UEST, SimpleTest)
 	ASSERT_THAT(NAN, Is::NaN);
 }
 
+TEST(UEST, BulkMatchers)
+{
+	// Odd sizes, so both vector kernels and scalar tails are used
+	TArray<float> Floats;
+	for (auto Index = 0; Index < 1001; ++Index)
+	{
+		Floats.Add(Index * 0.001f);
+	}
+
+	auto NearlyFloats = Floats;
+	NearlyFloats[7] += 0.005f;
+
+	ASSERT_THAT(NearlyFloats, Is::AllNearlyEqualTo<float>(Floats, 0.01f));
+	ASSERT_THAT(Floats, Is::AllInRange<float>(0.f, 1.f));
+	ASSERT_THAT(Floats, Is::AllFinite());
+
+	const TArray<FVector> Vectors{FVector::ZeroVector, FVector::OneVector, FVector{1, 2, 3}, FVector::UpVector, FVector::ForwardVector};
+	ASSERT_THAT(TConstArrayView<FVector>{Vectors}, Is::AllNearlyEqualTo<FVector>(Vectors));
+	ASSERT_THAT(Vectors, Is::AllInRange<double>(0, 3));
+	ASSERT_THAT(Vectors, Is::AllFinite());
+
+	const TArray<FRotator> Rotators{FRotator{0, 180, 0}, FRotator{0, 90, 0}};
+	const TArray<FRotator> WrappedRotators{FRotator{0, -180, 0}, FRotator{0, 450, 0}};
+	ASSERT_THAT(WrappedRotators, Is::AllNearlyEqualTo<FRotator>(Rotators, 0.001));
+
+	auto WrongFloats = Floats;
+	WrongFloats[3] = NAN;
+	WrongFloats[1000] = 2.f;
+	const UEST::Matchers::AllNearlyEqualTo<float> NearlyEqual{Floats, 0.01f};
+	ASSERT_THAT(NearlyEqual.Matches<TArray<float>>(WrongFloats), Is::False);
+	ASSERT_THAT(NearlyEqual.Mismatches.Num, Is::EqualTo<int32>(2));
+	ASSERT_THAT(NearlyEqual.Mismatches.FirstIndices[0], Is::EqualTo<int32>(3));
+	ASSERT_THAT(NearlyEqual.Mismatches.FirstIndices[1], Is::EqualTo<int32>(1000));
+	TStringBuilder<256> Description;
+	NearlyEqual.Describe(Description);
+	ASSERT_THAT(FString{Description.ToView()}.Contains(TEXT("[1000] 2.000 instead of 1.000")));
+
+	const UEST::Matchers::AllFinite Finite{};
+	ASSERT_THAT(Finite.Matches<TArray<float>>(WrongFloats), Is::False);
+	ASSERT_THAT(Finite.Mismatches.Num, Is::EqualTo<int32>(1));
+
+	auto WrongVectors = Vectors;
+	WrongVectors[2].Y = INFINITY;
+	WrongVectors[2].Z = -1;
+	WrongVectors[4].X = -1;
+	const UEST::Matchers::AllInRange<double> InRange{0, 3};
+	ASSERT_THAT(InRange.Matches<TArray<FVector>>(WrongVectors), Is::False);
+	ASSERT_THAT(InRange.Mismatches.Num, Is::EqualTo<int32>(2));
+	ASSERT_THAT(InRange.Mismatches.FirstIndices[1], Is::EqualTo<int32>(4));
+}
+
+TEST(UEST, FailedAssertion)
+{
+	const auto ErrorsBefore = ExecutionInfo.GetErrorTotal();
+	auto bReturned = true;
+	int32 AssertionLine = 0;
+	[&] {
+		AssertionLine = __LINE__ + 1;
+		ASSERT_THAT(1 + 1, Is::EqualTo<int32>(3));
+		bReturned = false;
+	}();
+	const auto ErrorsAfter = ExecutionInfo.GetErrorTotal();
+	const auto Message = ExecutionInfo.GetEntries().Last().Event.Message;
+
+	// Error was expected, it must not fail this test
+	ExecutionInfo.RemoveAllEvents(EAutomationEventType::Error);
+
+	ASSERT_THAT(bReturned);
+	ASSERT_THAT(ErrorsAfter, Is::EqualTo<int32>(ErrorsBefore + 1));
+	ASSERT_THAT(Message.Contains(TEXT("1 + 1")));
+
+	// Stack is not captured, so location comes from the assertion itself
+	ASSERT_THAT(Message.Contains(FString::Printf(TEXT("UESTTests.cpp(%d)]"), AssertionLine)));
+}
+
+TEST(UEST, FailureDescription)
+{
+	TArray<int32> Values;
+	for (auto Index = 0; Index < 100; ++Index)
+	{
+		Values.Add(Index);
+	}
+
+	TStringBuilder<256> Description;
+	UEST::AppendValue(Description, TArrayView<const int32>{Values}.Left(3));
+	ASSERT_THAT(FString{Description.ToView()}, Is::EqualTo<FString>(TEXT("[0, 1, 2]")));
+
+	// Large containers are truncated
+	Description.Reset();
+	UEST::AppendValue(Description, Values);
+	ASSERT_THAT(FString{Description.ToView()}.EndsWith(TEXT("14, 15, ... 84 more]")));
+
+	const FString Expected{TEXT("abc")};
+	const auto NotEqualTo = Is::Not::EqualTo<FString>(Expected);
+	ASSERT_THAT(&NotEqualTo.Nested.Expected.Get(), Is::EqualTo<const FString*>(&Expected));
+
+	Description.Reset();
+	UEST::DescribeMatcher(Description, NotEqualTo);
+	ASSERT_THAT(FString{Description.ToView()}, Is::EqualTo<FString>(TEXT("not be equal to abc")));
+}
+
+TEST(UEST, BitFieldExpectedValue)
+{
+	struct FFlags
+	{
+		uint8 bFirst : 1;
+		uint8 bSecond : 1;
+	};
+
+	FFlags Flags{true, false};
+
+	// Bit field cannot be referenced, so matcher has to keep its own copy rather than point to a temporary
+	const auto EqualTo = Is::EqualTo<uint8>(Flags.bFirst);
+	Flags.bFirst = false;
+	ASSERT_THAT(EqualTo.Expected.Get(), Is::EqualTo<uint8>(1));
+	ASSERT_THAT(EqualTo.Matches<uint8>(Flags.bSecond), Is::False);
+}
+
 TEST(UEST, Test, With, Deep, Naming)
 {
 	ASSERT_THAT(true, Is::True);
 }
 
+TEST(UEST, Test, Registry)
+{
+	const FUESTTestBase* Self = nullptr;
+	const FUESTTestBase* Disabled = nullptr;
+	const FUESTTestBase* Class = nullptr;
+	for (const auto* Test : FUESTTestBase::GetRegisteredTests())
+	{
+		if (Test == this)
+		{
+			Self = Test;
+		}
+		else if (Test->GetBeautifiedTestName() == TEXT("UEST.Test.Disabled"))
+		{
+			Disabled = Test;
+		}
+		else if (Test->GetBeautifiedTestName() == TEXT("UEST.SimpleTestClass"))
+		{
+			Class = Test;
+		}
+	}
+
+	ASSERT_THAT(Self, Is::Not::Null);
+	ASSERT_THAT(Self->IsComplexTest(), Is::False);
+	ASSERT_THAT(Self->GetTestMethodNames().Num(), Is::EqualTo(0));
+	ASSERT_THAT(Disabled, Is::Not::Null);
+	ASSERT_THAT((static_cast<uint64>(Disabled->GetTestFlags()) & static_cast<uint64>(EAutomationTestFlags::Disabled)) != 0);
+	ASSERT_THAT(Class, Is::Not::Null);
+	ASSERT_THAT(Class->IsComplexTest(), Is::True);
+
+	// Methods are listed in declaration order
+	const auto MethodNames = Class->GetTestMethodNames();
+	ASSERT_THAT(MethodNames.Num(), Is::EqualTo(2));
+	ASSERT_THAT(MethodNames[0] == TEXT("Test1"));
+	ASSERT_THAT(MethodNames[1] == TEXT("Test2"));
+}
+
 TEST_DISABLED(UEST, Test, Disabled)
 {
 	ASSERT_THAT(true, Is::False);
@@ -131,3 +293,121 @@ TEST_CLASS_DISABLED(UEST, TestClass, Disabled)
 	}
 };
 // clang-format on
+
+TEST(UEST, TestManifest)
+{
+	TSharedPtr<FJsonObject> Manifest;
+	ASSERT_THAT(FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(FUESTTestManifest::Generate()), Manifest), Is::True);
+	ASSERT_THAT(Manifest->GetIntegerField(TEXT("Version")), Is::EqualTo<int32>(FUESTTestManifest::Version));
+
+	TSharedPtr<FJsonObject> SimpleTestClass;
+	for (const auto& Test : Manifest->GetArrayField(TEXT("Tests")))
+	{
+		if (Test->AsObject()->GetStringField(TEXT("Name")) == TEXT("UEST.SimpleTestClass"))
+		{
+			SimpleTestClass = Test->AsObject();
+		}
+	}
+
+	ASSERT_THAT(SimpleTestClass, Is::Valid);
+	ASSERT_THAT(SimpleTestClass->GetBoolField(TEXT("Complex")), Is::True);
+	ASSERT_THAT(SimpleTestClass->GetArrayField(TEXT("Methods")).Num(), Is::Positive);
+}
+
+TEST(UEST, TestQueue)
+{
+	const FUESTTestQueue Queue{FPaths::ConvertRelativePathToFull(FPaths::ProjectIntermediateDir() / TEXT("UEST") / FGuid::NewGuid().ToString())};
+	ON_SCOPE_EXIT
+	{
+		IFileManager::Get().DeleteDirectory(*Queue.GetRunDir(), false, true);
+	};
+
+	const TArray<FUESTQueuedTest> Tests{
+	    {TEXT("UEST.A"), TEXT("UEST.A"), TEXT("A.cpp"), 1},
+	    {TEXT("UEST.B"), TEXT("UEST.B"), TEXT("B.cpp"), 2},
+	    {TEXT("UEST.C"), TEXT("UEST.C"), TEXT("C.cpp"), 3},
+	};
+	ASSERT_THAT(Queue.Enqueue(Tests), Is::True);
+
+	// Tests are claimed in order, each one only once
+	int32 Index = INDEX_NONE;
+	FString FullName;
+	ASSERT_THAT(Queue.Claim(Index, FullName), Is::EqualTo<EUESTTestClaimResult>(EUESTTestClaimResult::Claimed));
+	ASSERT_THAT(Index, Is::EqualTo<int32>(0));
+	ASSERT_THAT(FullName, Is::EqualTo<FString>(TEXT("UEST.A")));
+
+	ASSERT_THAT(Queue.Claim(Index, FullName), Is::EqualTo<EUESTTestClaimResult>(EUESTTestClaimResult::Claimed));
+	ASSERT_THAT(Index, Is::EqualTo<int32>(1));
+	ASSERT_THAT(FullName, Is::EqualTo<FString>(TEXT("UEST.B")));
+
+	const auto Passed = MakeShared<FJsonObject>();
+	Passed->SetBoolField(TEXT("Succeeded"), true);
+	Queue.SetResult(0, Passed);
+
+	// Second test was claimed by a worker that never reported back, third one was not claimed at all
+	const auto Report = Queue.MakeReport(Tests, 2, 1);
+	ASSERT_THAT(Report->GetIntegerField(TEXT("NumTests")), Is::EqualTo<int32>(3));
+	ASSERT_THAT(Report->GetIntegerField(TEXT("NumFailed")), Is::EqualTo<int32>(2));
+
+	const auto& JsonTests = Report->GetArrayField(TEXT("Tests"));
+	ASSERT_THAT(JsonTests[0]->AsObject()->GetBoolField(TEXT("Succeeded")), Is::True);
+	ASSERT_THAT(JsonTests[0]->AsObject()->GetStringField(TEXT("SourceFile")), Is::EqualTo<FString>(TEXT("A.cpp")));
+	ASSERT_THAT(JsonTests[1]->AsObject()->GetArrayField(TEXT("Errors"))[0]->AsObject()->GetStringField(TEXT("Message")), Is::EqualTo<FString>(TEXT("Worker process exited while running this test")));
+	ASSERT_THAT(JsonTests[2]->AsObject()->GetArrayField(TEXT("Errors"))[0]->AsObject()->GetStringField(TEXT("Message")), Is::EqualTo<FString>(TEXT("Test was not run")));
+
+	// Test that cannot be moved to Claimed directory is not retried forever
+	const auto BlockingFile = Queue.GetRunDir() / TEXT("Claimed") / FString::Printf(TEXT("%06d"), 2);
+	ASSERT_THAT(FFileHelper::SaveStringToFile(TEXT("UEST.C"), *BlockingFile));
+	ASSERT_THAT(Queue.Claim(Index, FullName), Is::EqualTo<EUESTTestClaimResult>(EUESTTestClaimResult::Failed));
+
+	ASSERT_THAT(IFileManager::Get().Delete(*BlockingFile));
+	ASSERT_THAT(Queue.Claim(Index, FullName), Is::EqualTo<EUESTTestClaimResult>(EUESTTestClaimResult::Claimed));
+	ASSERT_THAT(Queue.Claim(Index, FullName), Is::EqualTo<EUESTTestClaimResult>(EUESTTestClaimResult::QueueEmpty));
+
+	ASSERT_THAT(FUESTTestQueue::GetNumShards(8, 3), Is::EqualTo<int32>(3));
+	ASSERT_THAT(FUESTTestQueue::GetNumShards(8, 0), Is::EqualTo<int32>(1));
+	ASSERT_THAT(FUESTTestQueue::GetNumShards(0, 3), Is::EqualTo<int32>(1));
+}
+
+TEST(UEST, BenchmarkResult)
+{
+	const auto Result = FUESTBenchmarkResult::FromSamples(TEXT("UEST.Result"), {5, 1, 4, 2, 3, 100}, 10);
+	ASSERT_THAT(Result.NumSamples, Is::EqualTo<int32>(6));
+	ASSERT_THAT(Result.MinSeconds, Is::EqualTo<double>(1));
+	ASSERT_THAT(Result.MedianSeconds, Is::EqualTo<double>(3.5));
+	ASSERT_THAT(Result.P95Seconds, Is::EqualTo<double>(100));
+	ASSERT_THAT(Result.MeanSeconds, Is::NearlyEqualTo<double, double>(115. / 6, 0.001));
+	ASSERT_THAT(Result.HasAllocations(), Is::False);
+
+	auto WithAllocations = Result;
+	WithAllocations.AllocationsPerIteration = 2;
+	WithAllocations.AllocatedBytesPerIteration = 64;
+
+	const auto Parsed = FUESTBenchmarkResult::FromJson(WithAllocations.ToJson());
+	ASSERT_THAT(Parsed.IsSet(), Is::True);
+	ASSERT_THAT(Parsed->Name, Is::EqualTo<FString>(TEXT("UEST.Result")));
+	ASSERT_THAT(Parsed->IterationsPerSample, Is::EqualTo<int64>(10));
+	ASSERT_THAT(Parsed->MedianSeconds, Is::EqualTo<double>(3.5));
+	ASSERT_THAT(Parsed->AllocationsPerIteration, Is::EqualTo<double>(2));
+
+	ASSERT_THAT(FUESTBenchmarkResult::FromJson(TEXT("{\"Version\": 0}")).IsSet(), Is::False);
+}
+
+BENCHMARK(UEST, Benchmark, Sum)
+{
+	TArray<int32> Values;
+	for (auto Index = 0; Index < 1000; ++Index)
+	{
+		Values.Add(Index);
+	}
+
+	for (auto _ : Benchmark)
+	{
+		auto Sum = 0;
+		for (const auto Value : Values)
+		{
+			Sum += Value;
+		}
+		FUESTBenchmark::DoNotOptimize(Sum);
+	}
+}
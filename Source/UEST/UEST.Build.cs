@@ -11,6 +11,9 @@ public class UEST : ModuleRules
 			"Engine",
 			"EngineSettings",
 			"IrisCore",
+			"Json",
+			"PacketHandler",
+			"Sockets",
 			"TypedElementFramework",
 		});
 	}